@@ -0,0 +1,201 @@
+#include "asset_archive.h"
+#include "page_allocator.h"
+#include <algorithm>
+#include <fstream>
+
+namespace engine::assets {
+
+//===========================================================================
+// AssetArchive
+//===========================================================================
+
+AssetArchive::~AssetArchive()
+{
+    close();
+}
+
+auto AssetArchive::open(const char* path) -> bool
+{
+    close();
+
+    mapping_ = memory::map_file(path);
+    if (mapping_.data == nullptr) {
+        return false;
+    }
+
+    if (mapping_.size < sizeof(ArchiveHeader)) {
+        close();
+        return false;
+    }
+
+    // only the header is checked; entries are checked when looked up
+    const ArchiveHeader& h = header();
+    u64 index_size = u64{h.entry_count} * sizeof(ArchiveEntry);
+    bool valid = h.magic == ArchiveHeader::MAGIC &&
+                 h.version == ArchiveHeader::VERSION &&
+                 h.file_size == mapping_.size &&
+                 h.index_offset % alignof(ArchiveEntry) == 0 &&
+                 h.index_offset + index_size <= mapping_.size &&
+                 h.names_offset <= mapping_.size;
+    if (!valid) {
+        close();
+    }
+    return valid;
+}
+
+void AssetArchive::close()
+{
+    memory::unmap_file(mapping_);
+}
+
+auto AssetArchive::header() const -> const ArchiveHeader&
+{
+    return *static_cast<const ArchiveHeader*>(mapping_.data);
+}
+
+auto AssetArchive::entries() const -> std::span<const ArchiveEntry>
+{
+    if (!is_open()) {
+        return {};
+    }
+    const auto* base = static_cast<const u8*>(mapping_.data);
+    return {
+        reinterpret_cast<const ArchiveEntry*>(base + header().index_offset),
+        header().entry_count,
+    };
+}
+
+auto AssetArchive::name(const ArchiveEntry& entry) const -> std::string_view
+{
+    u64 names_offset = header().names_offset;
+    if (entry.name_offset + entry.name_length > mapping_.size - names_offset) {
+        return {};
+    }
+    const auto* base = static_cast<const char*>(mapping_.data);
+    return {base + names_offset + entry.name_offset, entry.name_length};
+}
+
+auto AssetArchive::find(u64 name_hash, Asset& asset) const -> bool
+{
+    auto index = entries();
+    const auto* end = index.data() + index.size();
+    const auto* entry = std::lower_bound(
+        index.data(),
+        end,
+        name_hash,
+        [](const ArchiveEntry& e, u64 hash) { return e.name_hash < hash; }
+    );
+    if (entry == end || entry->name_hash != name_hash) {
+        return false;
+    }
+    if (entry->offset > mapping_.size ||
+        entry->size > mapping_.size - entry->offset) {
+        return false;
+    }
+
+    const auto* base = static_cast<const u8*>(mapping_.data);
+    asset = {entry->type, {base + entry->offset, entry->size}};
+    return true;
+}
+
+auto AssetArchive::find(std::string_view name, Asset& asset) const -> bool
+{
+    return find(asset_name_hash(name), asset);
+}
+
+//===========================================================================
+// ArchiveBuilder
+//===========================================================================
+
+auto ArchiveBuilder::add(
+    std::string_view name,
+    AssetType type,
+    std::span<const u8> bytes
+) -> bool
+{
+    u64 hash = asset_name_hash(name);
+    bool taken = std::any_of(
+        assets_.begin(),
+        assets_.end(),
+        [&](const PendingAsset& asset) { return asset.name_hash == hash; }
+    );
+    if (taken) {
+        return false;
+    }
+
+    assets_.push_back({
+        std::string{name},                           // name
+        hash,                                        // name_hash
+        type,                                        // type
+        std::vector<u8>{bytes.begin(), bytes.end()}, // bytes
+    });
+    return true;
+}
+
+auto ArchiveBuilder::write(const char* path) const -> bool
+{
+    std::vector<const PendingAsset*> sorted{};
+    sorted.reserve(assets_.size());
+    for (const auto& asset : assets_) {
+        sorted.push_back(&asset);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const auto* a, const auto* b) {
+        return a->name_hash < b->name_hash;
+    });
+
+    // header, index and names first, then the aligned blobs
+    ArchiveHeader header{};
+    header.magic = ArchiveHeader::MAGIC;
+    header.version = ArchiveHeader::VERSION;
+    header.entry_count = static_cast<u32>(sorted.size());
+    header.index_offset = sizeof(ArchiveHeader);
+    header.names_offset =
+        header.index_offset + sorted.size() * sizeof(ArchiveEntry);
+
+    std::vector<ArchiveEntry> index{};
+    std::string names{};
+    u64 names_end = header.names_offset;
+    for (const auto* asset : sorted) {
+        names_end += asset->name.size();
+    }
+
+    u64 offset = names_end;
+    for (const auto* asset : sorted) {
+        offset = memory::align_up(offset, ArchiveHeader::BLOB_ALIGNMENT);
+        index.push_back({
+            asset->name_hash,                     // name_hash
+            asset->type,                          // type
+            static_cast<u32>(asset->name.size()), // name_length
+            names.size(),                         // name_offset
+            offset,                               // offset
+            asset->bytes.size(),                  // size
+        });
+        names += asset->name;
+        offset += asset->bytes.size();
+    }
+    header.file_size = offset;
+
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    auto write_bytes = [&](const void* data, u64 size) {
+        file.write(
+            static_cast<const char*>(data),
+            static_cast<std::streamsize>(size)
+        );
+    };
+
+    write_bytes(&header, sizeof(header));
+    write_bytes(index.data(), index.size() * sizeof(ArchiveEntry));
+    write_bytes(names.data(), names.size());
+
+    u64 position = names_end;
+    const u8 padding[ArchiveHeader::BLOB_ALIGNMENT]{};
+    for (u64 i = 0; i < sorted.size(); ++i) {
+        write_bytes(padding, index[i].offset - position);
+        write_bytes(sorted[i]->bytes.data(), sorted[i]->bytes.size());
+        position = index[i].offset + index[i].size;
+    }
+
+    return static_cast<bool>(file);
+}
+
+} // namespace engine::assets
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "core.h"
+#include "shared_memory.h"
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace engine::assets {
+
+/** Tells what the bytes of an asset hold. */
+enum AssetType : u32 {
+    /** Bytes used as they are. */
+    ASSET_RAW,
+    /** Closed outline; pairs of f32 (x, y). */
+    ASSET_MESH,
+    /** Colors; one ARGB value per entry. */
+    ASSET_PALETTE,
+};
+
+/** FNV-1a hash of an asset name; constexpr so lookups can be hashed early. */
+constexpr auto asset_name_hash(std::string_view name) -> u64
+{
+    u64 hash = 0xcbf29ce484222325;
+    for (char c : name) {
+        hash ^= static_cast<u8>(c);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+//===========================================================================
+// File layout
+//===========================================================================
+
+/**
+ * Start of an archive. The index follows the header; it is sorted by name
+ * hash so that a lookup is a binary search. Blobs start at multiples of
+ * BLOB_ALIGNMENT from the start of the file, so mapped data can be used in
+ * place as arrays of any basic type.
+ */
+struct ArchiveHeader {
+    static constexpr u32 MAGIC = 0x4b434150; // "PACK"
+    static constexpr u32 VERSION = 1;
+    static constexpr u64 BLOB_ALIGNMENT = 64;
+
+    u32 magic;
+    u32 version;
+    u32 entry_count;
+    u32 reserved;
+    u64 index_offset;
+    /** Names of all entries back to back; for listings and diagnostics. */
+    u64 names_offset;
+    u64 file_size;
+};
+
+struct ArchiveEntry {
+    u64 name_hash;
+    AssetType type;
+    u32 name_length;
+    u64 name_offset;
+    u64 offset;
+    u64 size;
+};
+
+//===========================================================================
+// AssetArchive
+//===========================================================================
+
+/** An asset inside a mapped archive; valid while the archive is open. */
+struct Asset {
+    AssetType type;
+    std::span<const u8> bytes;
+
+    /** The bytes as an array of T; a partial T at the end is cut off. */
+    template <typename T>
+    [[nodiscard]] auto as() const -> std::span<const T>
+    {
+        return {
+            reinterpret_cast<const T*>(bytes.data()),
+            bytes.size() / sizeof(T),
+        };
+    }
+};
+
+/**
+ * Read side of a packed archive.
+ *
+ * Opening maps the file and checks the header, nothing else: there is no
+ * parsing and no copying, the index and blobs are used straight from the
+ * mapped pages, and only the pages actually touched are ever read from
+ * disk.
+ */
+class AssetArchive final {
+public:
+    DEFAULT_CTOR(AssetArchive);
+    DELETE_COPY(AssetArchive);
+    DELETE_MOVE(AssetArchive);
+
+    ~AssetArchive();
+
+    auto open(const char* path) -> bool;
+
+    void close();
+
+    [[nodiscard]] auto is_open() const -> bool
+    {
+        return mapping_.data != nullptr;
+    }
+
+    /** Looks up an asset; returns false if there is none of that name. */
+    auto find(std::string_view name, Asset& asset) const -> bool;
+
+    auto find(u64 name_hash, Asset& asset) const -> bool;
+
+    [[nodiscard]] auto entries() const -> std::span<const ArchiveEntry>;
+
+    [[nodiscard]] auto name(const ArchiveEntry& entry) const
+        -> std::string_view;
+
+private:
+    [[nodiscard]] auto header() const -> const ArchiveHeader&;
+
+    memory::SharedMapping mapping_{};
+};
+
+//===========================================================================
+// ArchiveBuilder
+//===========================================================================
+
+/**
+ * Collects assets and writes them as an archive; used by the packer tool.
+ */
+class ArchiveBuilder final {
+public:
+    DEFAULT_CTOR(ArchiveBuilder);
+    DEFAULT_DTOR(ArchiveBuilder);
+    DELETE_COPY(ArchiveBuilder);
+    DEFAULT_MOVE(ArchiveBuilder);
+
+    /**
+     * Adds a copy of the bytes. Returns false if the name is taken or its
+     * hash collides with one that is.
+     */
+    auto add(std::string_view name, AssetType type, std::span<const u8> bytes)
+        -> bool;
+
+    auto write(const char* path) const -> bool;
+
+    [[nodiscard]] auto asset_count() const -> u32
+    {
+        return static_cast<u32>(assets_.size());
+    }
+
+private:
+    struct PendingAsset {
+        std::string name;
+        u64 name_hash;
+        AssetType type;
+        std::vector<u8> bytes;
+    };
+
+    std::vector<PendingAsset> assets_{};
+};
+
+} // namespace engine::assets
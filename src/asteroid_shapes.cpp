@@ -0,0 +1,109 @@
+#include "asteroid_shapes.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace engine::graphics {
+
+namespace {
+
+/**
+ * SplitMix64; unlike the standard distributions its output is the same
+ * with every standard library.
+ */
+class ShapeRandom final {
+public:
+    explicit ShapeRandom(u64 seed) :
+        state_(seed)
+    {
+    }
+
+    auto next() -> u64
+    {
+        u64 z = (state_ += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+    }
+
+    /** Uniform in [0, 1). */
+    auto unit() -> f32
+    {
+        return static_cast<f32>(next() >> 40) / static_cast<f32>(1 << 24);
+    }
+
+private:
+    u64 state_;
+};
+
+} // namespace
+
+auto AsteroidShapes::generate(
+    u64 seed,
+    u32 size_class,
+    u32 variant,
+    const AsteroidShapeClass& shape_class,
+    std::span<math::vec2, MAX_VERTICES> vertices
+) -> u32
+{
+    ShapeRandom random{
+        seed ^ (u64{size_class} << 48) ^ (u64{variant} << 32),
+    };
+    // the first outputs of nearby seeds are correlated; skip them
+    random.next();
+
+    u32 count = std::clamp(shape_class.vertex_count, 3u, MAX_VERTICES);
+    f32 step = math::TWO_PI / static_cast<f32>(count);
+    f32 offset = random.unit() * math::TWO_PI;
+
+    f32 radius_max = 0.0f;
+    for (u32 i = 0; i < count; ++i) {
+        // the jitter keeps each vertex inside its own sector
+        f32 angle = offset + step * (static_cast<f32>(i) +
+                                     (random.unit() - 0.5f) * 0.8f);
+        f32 radius = 1.0f - shape_class.roughness * random.unit();
+        vertices[i] = math::from_angle(angle) * radius;
+        radius_max = std::max(radius_max, radius);
+    }
+
+    for (u32 i = 0; i < count; ++i) {
+        vertices[i] *= 1.0f / radius_max;
+    }
+    return count;
+}
+
+void AsteroidShapes::build(
+    MeshLibrary& library,
+    u64 seed,
+    std::span<const AsteroidShapeClass> classes,
+    u32 variants,
+    std::span<const std::span<const math::vec2>> overrides
+)
+{
+    class_count_ = static_cast<u32>(classes.size());
+    variants_ = variants;
+    meshes_.clear();
+    meshes_.reserve(classes.size() * variants);
+
+    std::array<math::vec2, MAX_VERTICES> vertices{};
+    for (u32 size_class = 0; size_class < class_count_; ++size_class) {
+        for (u32 variant = 0; variant < variants; ++variant) {
+            u64 index = u64{size_class} * variants + variant;
+            if (index < overrides.size() && !overrides[index].empty()) {
+                meshes_.push_back(library.add(overrides[index]));
+                continue;
+            }
+
+            u32 count = generate(
+                seed,
+                size_class,
+                variant,
+                classes[size_class],
+                vertices
+            );
+            meshes_.push_back(library.add({vertices.data(), count}));
+        }
+    }
+}
+
+} // namespace engine::graphics
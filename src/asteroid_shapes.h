@@ -0,0 +1,87 @@
+#pragma once
+
+#include "core.h"
+#include "mesh_batch.h"
+#include "vecmath.h"
+#include <span>
+#include <vector>
+
+namespace engine::graphics {
+
+struct AsteroidShapeClass {
+    /** Outline vertices; bigger rocks look better with more. */
+    u32 vertex_count;
+    /** How far vertices may sink towards the centre, 0..1. */
+    f32 roughness;
+};
+
+//===========================================================================
+// AsteroidShapes
+//===========================================================================
+
+/**
+ * Library of jagged rock outlines generated once at startup.
+ *
+ * Every outline is a pure function of (seed, size class, variant), so the
+ * same seed gives the same rocks on every run and compiler; the shapes
+ * use their own generator and leave the game's random sequence alone. All
+ * meshes go into one MeshLibrary back to back, and a spawned rock only
+ * stores the MeshId of the variant it picked.
+ *
+ * Outlines are unit sized: the farthest vertex is at distance 1, so
+ * instances scale them to their size.
+ */
+class AsteroidShapes final {
+public:
+    DEFAULT_CTOR(AsteroidShapes);
+    DEFAULT_DTOR(AsteroidShapes);
+    DELETE_COPY(AsteroidShapes);
+    DEFAULT_MOVE(AsteroidShapes);
+
+    static constexpr u32 MAX_VERTICES = 32;
+
+    /**
+     * Writes one outline into `vertices` and returns its vertex count. The
+     * vertices run counter-clockwise at increasing angles, so the outline
+     * never crosses itself.
+     */
+    static auto generate(
+        u64 seed,
+        u32 size_class,
+        u32 variant,
+        const AsteroidShapeClass& shape_class,
+        std::span<math::vec2, MAX_VERTICES> vertices
+    ) -> u32;
+
+    /**
+     * Generates `variants` outlines for each class and adds them to
+     * `library`. Calling it again adds a new set.
+     *
+     * `overrides` may hold hand-made outlines, indexed like the meshes by
+     * size_class * variants + variant; a non-empty one is added instead of
+     * the generated outline. It may be shorter than that or empty.
+     */
+    void build(
+        MeshLibrary& library,
+        u64 seed,
+        std::span<const AsteroidShapeClass> classes,
+        u32 variants,
+        std::span<const std::span<const math::vec2>> overrides = {}
+    );
+
+    [[nodiscard]] auto mesh(u32 size_class, u32 variant) const -> MeshId
+    {
+        return meshes_[size_class * variants_ + variant];
+    }
+
+    [[nodiscard]] auto class_count() const -> u32 { return class_count_; }
+    [[nodiscard]] auto variants() const -> u32 { return variants_; }
+
+private:
+    u32 class_count_{0};
+    u32 variants_{0};
+    // indexed by size_class * variants_ + variant
+    std::vector<MeshId> meshes_{};
+};
+
+} // namespace engine::graphics
@@ -0,0 +1,404 @@
+#include "audio_mixer.h"
+#include "simd.h"
+#include "time.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace engine::audio {
+
+//===========================================================================
+// Bus accumulation and conversion
+//===========================================================================
+
+namespace {
+
+constexpr f32 SAMPLE_MAX = 32767.0f;
+constexpr f32 SAMPLE_MIN = -32768.0f;
+
+/**
+ * Scalar reference; adds samples [begin, count) to both buses.
+ */
+void accumulate_scalar(
+    const s16* samples,
+    u32 begin,
+    u32 count,
+    f32 gain_left,
+    f32 gain_right,
+    f32* left,
+    f32* right
+)
+{
+    for (u32 i = begin; i < count; ++i) {
+        auto sample = static_cast<f32>(samples[i]);
+        left[i] += sample * gain_left;
+        right[i] += sample * gain_right;
+    }
+}
+
+void accumulate(
+    const s16* samples,
+    u32 count,
+    f32 gain_left,
+    f32 gain_right,
+    f32* left,
+    f32* right
+)
+{
+    u32 i = 0;
+#if defined(ENGINE_SIMD_AVX2)
+    const __m256 gl8 = _mm256_set1_ps(gain_left);
+    const __m256 gr8 = _mm256_set1_ps(gain_right);
+    for (; i + 8 <= count; i += 8) {
+        __m128i packed =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+        __m256 s = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(packed));
+        _mm256_storeu_ps(
+            left + i,
+            _mm256_add_ps(_mm256_loadu_ps(left + i), _mm256_mul_ps(s, gl8))
+        );
+        _mm256_storeu_ps(
+            right + i,
+            _mm256_add_ps(_mm256_loadu_ps(right + i), _mm256_mul_ps(s, gr8))
+        );
+    }
+#endif
+#if defined(ENGINE_SIMD_SSE2)
+    const __m128 gl4 = _mm_set1_ps(gain_left);
+    const __m128 gr4 = _mm_set1_ps(gain_right);
+    for (; i + 4 <= count; i += 4) {
+        __m128i packed =
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(samples + i));
+        // sign extends by moving each sample into the upper half of a lane
+        __m128i wide = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+        __m128 s = _mm_cvtepi32_ps(wide);
+        _mm_storeu_ps(
+            left + i,
+            _mm_add_ps(_mm_loadu_ps(left + i), _mm_mul_ps(s, gl4))
+        );
+        _mm_storeu_ps(
+            right + i,
+            _mm_add_ps(_mm_loadu_ps(right + i), _mm_mul_ps(s, gr4))
+        );
+    }
+#endif
+    accumulate_scalar(samples, i, count, gain_left, gain_right, left, right);
+}
+
+/**
+ * Scalar reference; converts frames [begin, count) with rounding and
+ * saturation.
+ */
+void convert_scalar(
+    const f32* left,
+    const f32* right,
+    u32 begin,
+    u32 count,
+    f32 volume,
+    s16* output
+)
+{
+    for (u32 i = begin; i < count; ++i) {
+        f32 l = std::clamp(left[i] * volume, SAMPLE_MIN, SAMPLE_MAX);
+        f32 r = std::clamp(right[i] * volume, SAMPLE_MIN, SAMPLE_MAX);
+        output[2 * i] = static_cast<s16>(std::lrint(l));
+        output[2 * i + 1] = static_cast<s16>(std::lrint(r));
+    }
+}
+
+void convert(
+    const f32* left,
+    const f32* right,
+    u32 count,
+    f32 volume,
+    s16* output
+)
+{
+    u32 i = 0;
+#if defined(ENGINE_SIMD_SSE2)
+    const __m128 v = _mm_set1_ps(volume);
+    // clamped first: out of range floats would convert to INT32_MIN
+    const __m128 high = _mm_set1_ps(SAMPLE_MAX);
+    const __m128 low = _mm_set1_ps(SAMPLE_MIN);
+    auto to_int = [&](const f32* bus) {
+        __m128 s = _mm_mul_ps(_mm_load_ps(bus), v);
+        return _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(s, high), low));
+    };
+    for (; i + 8 <= count; i += 8) {
+        __m128i l = _mm_packs_epi32(to_int(left + i), to_int(left + i + 4));
+        __m128i r = _mm_packs_epi32(to_int(right + i), to_int(right + i + 4));
+        auto* out = reinterpret_cast<__m128i*>(output + 2 * i);
+        _mm_storeu_si128(out, _mm_unpacklo_epi16(l, r));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(l, r));
+    }
+#endif
+    convert_scalar(left, right, i, count, volume, output);
+}
+
+} // namespace
+
+//===========================================================================
+// VoiceMixer
+//===========================================================================
+
+auto VoiceMixer::play(
+    VoiceId id,
+    const Sound& sound,
+    f32 volume,
+    f32 pan,
+    bool loop
+) -> bool
+{
+    if (active_count_ == MAX_VOICES || sound.samples.empty()) {
+        return false;
+    }
+
+    voices_[active_count_++] = {
+        sound.samples.data(),                   // samples
+        static_cast<u32>(sound.samples.size()), // length
+        0,                                      // position
+        0.0f,                                   // gain_left
+        0.0f,                                   // gain_right
+        id,                                     // id
+        loop,                                   // loop
+    };
+    set_volume(id, volume, pan);
+    return true;
+}
+
+auto VoiceMixer::find(VoiceId id) -> Voice*
+{
+    for (u32 i = 0; i < active_count_; ++i) {
+        if (voices_[i].id == id) {
+            return &voices_[i];
+        }
+    }
+    return nullptr;
+}
+
+void VoiceMixer::stop(VoiceId id)
+{
+    Voice* voice = find(id);
+    if (voice != nullptr) {
+        // keeps the active voices packed
+        *voice = voices_[--active_count_];
+    }
+}
+
+void VoiceMixer::set_volume(VoiceId id, f32 volume, f32 pan)
+{
+    Voice* voice = find(id);
+    if (voice == nullptr) {
+        return;
+    }
+    // linear pan; the centre plays at full volume on both sides
+    pan = std::clamp(pan, -1.0f, 1.0f);
+    voice->gain_left = volume * std::min(1.0f, 1.0f - pan);
+    voice->gain_right = volume * std::min(1.0f, 1.0f + pan);
+}
+
+void VoiceMixer::stop_all()
+{
+    active_count_ = 0;
+}
+
+void VoiceMixer::mix(std::span<s16> output)
+{
+    auto frames = std::min(
+        static_cast<u32>(output.size() / 2),
+        MAX_BLOCK_FRAMES
+    );
+    std::fill_n(bus_left_.data(), frames, 0.0f);
+    std::fill_n(bus_right_.data(), frames, 0.0f);
+
+    for (u32 i = 0; i < active_count_;) {
+        Voice& voice = voices_[i];
+        u32 mixed = 0;
+        while (mixed < frames) {
+            u32 count = std::min(frames - mixed, voice.length - voice.position);
+            accumulate(
+                voice.samples + voice.position,
+                count,
+                voice.gain_left,
+                voice.gain_right,
+                bus_left_.data() + mixed,
+                bus_right_.data() + mixed
+            );
+            mixed += count;
+            voice.position += count;
+            if (voice.position < voice.length || !voice.loop) {
+                break;
+            }
+            voice.position = 0;
+        }
+
+        if (voice.position == voice.length) {
+            // finished; the last voice moves here and is mixed next
+            voice = voices_[--active_count_];
+        } else {
+            ++i;
+        }
+    }
+
+    convert(
+        bus_left_.data(),
+        bus_right_.data(),
+        frames,
+        master_volume_,
+        output.data()
+    );
+}
+
+//===========================================================================
+// AudioMixer
+//===========================================================================
+
+AudioMixer::~AudioMixer()
+{
+    stop();
+}
+
+auto AudioMixer::start(AudioSink& sink, metrics::Histogram* mix_time) -> bool
+{
+    if (running_ || sink.kind() == SINK_CLOSED) {
+        return false;
+    }
+
+    sink_ = &sink;
+    mix_time_ = mix_time;
+    voices_.stop_all();
+    running_ = true;
+    mixer_ = std::jthread([this](std::stop_token stop_token) {
+        mixer_loop(stop_token);
+    });
+    return true;
+}
+
+void AudioMixer::stop()
+{
+    if (!running_) {
+        return;
+    }
+
+    mixer_.request_stop();
+    mixer_.join();
+
+    // commands sent after the last block would replay on the next start
+    Command command{};
+    while (commands_.try_pop(command)) {
+    }
+
+    sink_ = nullptr;
+    running_ = false;
+}
+
+auto AudioMixer::send(const Command& command) -> bool
+{
+    if (!running_ || !commands_.try_push(command)) {
+        commands_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+auto AudioMixer::play(const Sound& sound, f32 volume, f32 pan, bool loop)
+    -> VoiceId
+{
+    VoiceId voice = next_voice_;
+    Command command{
+        COMMAND_PLAY,                           // type
+        loop,                                   // loop
+        voice,                                  // voice
+        sound.samples.data(),                   // samples
+        static_cast<u32>(sound.samples.size()), // length
+        volume,                                 // volume
+        pan,                                    // pan
+    };
+    if (!send(command)) {
+        return 0;
+    }
+    // skips 0 when wrapping around
+    next_voice_ = next_voice_ == ~VoiceId{0} ? 1 : next_voice_ + 1;
+    return voice;
+}
+
+void AudioMixer::stop(VoiceId voice)
+{
+    send({COMMAND_STOP, false, voice, nullptr, 0, 0.0f, 0.0f});
+}
+
+void AudioMixer::set_volume(VoiceId voice, f32 volume, f32 pan)
+{
+    send({COMMAND_SET_VOLUME, false, voice, nullptr, 0, volume, pan});
+}
+
+void AudioMixer::stop_all()
+{
+    send({COMMAND_STOP_ALL, false, 0, nullptr, 0, 0.0f, 0.0f});
+}
+
+void AudioMixer::set_master_volume(f32 volume)
+{
+    send({COMMAND_MASTER_VOLUME, false, 0, nullptr, 0, volume, 0.0f});
+}
+
+void AudioMixer::apply(const Command& command)
+{
+    switch (command.type) {
+        case COMMAND_PLAY:
+            voices_.play(
+                command.voice,
+                Sound{{command.samples, command.length}},
+                command.volume,
+                command.pan,
+                command.loop
+            );
+            break;
+        case COMMAND_STOP:
+            voices_.stop(command.voice);
+            break;
+        case COMMAND_SET_VOLUME:
+            voices_.set_volume(command.voice, command.volume, command.pan);
+            break;
+        case COMMAND_STOP_ALL:
+            voices_.stop_all();
+            break;
+        case COMMAND_MASTER_VOLUME:
+            voices_.set_master_volume(command.volume);
+            break;
+    }
+}
+
+void AudioMixer::mixer_loop(const std::stop_token& stop_token)
+{
+    using Clock = std::chrono::steady_clock;
+    constexpr auto BLOCK_PERIOD = std::chrono::nanoseconds{
+        u64{BLOCK_FRAMES} * 1000000000 / SAMPLE_RATE
+    };
+
+    auto deadline = Clock::now();
+    while (!stop_token.stop_requested()) {
+        auto start = time::Instant::now();
+
+        Command command{};
+        while (commands_.try_pop(command)) {
+            apply(command);
+        }
+        voices_.mix(block_);
+
+        if (mix_time_ != nullptr) {
+            mix_time_->record(time::Duration::from(start));
+        }
+        blocks_mixed_.fetch_add(1, std::memory_order_relaxed);
+
+        sink_->write(block_);
+
+        if (!sink_->paces_itself()) {
+            // a late block does not make the following ones hurry
+            deadline = std::max(deadline + BLOCK_PERIOD, Clock::now());
+            std::this_thread::sleep_until(deadline);
+        }
+    }
+}
+
+} // namespace engine::audio
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "audio_sink.h"
+#include "core.h"
+#include "metrics.h"
+#include "spsc_queue.h"
+#include <array>
+#include <atomic>
+#include <span>
+#include <thread>
+
+namespace engine::audio {
+
+/** Mono 16-bit PCM at the mixer's sample rate; owned by the game. */
+struct Sound {
+    std::span<const s16> samples;
+};
+
+/** Handle of a playing sound; 0 is never a valid voice. */
+using VoiceId = u32;
+
+//===========================================================================
+// VoiceMixer
+//===========================================================================
+
+/**
+ * Mixes up to MAX_VOICES mono voices into a stereo float bus and converts
+ * the bus to interleaved 16-bit samples.
+ *
+ * Active voices are kept packed at the front of the voice array, so the
+ * mixing loop only walks voices that play. Each voice is accumulated into
+ * the bus with SIMD: samples are widened to float and added with their
+ * left and right gains. The conversion back saturates instead of wrapping.
+ *
+ * Not thread safe; AudioMixer runs one on its mixing thread.
+ */
+class VoiceMixer final {
+public:
+    DEFAULT_CTOR(VoiceMixer);
+    DEFAULT_DTOR(VoiceMixer);
+    DELETE_COPY(VoiceMixer);
+    DELETE_MOVE(VoiceMixer);
+
+    static constexpr u32 MAX_VOICES = 256;
+    static constexpr u32 MAX_BLOCK_FRAMES = 1024;
+
+    /** Returns false if all voices are busy or the sound is empty. */
+    auto play(VoiceId id, const Sound& sound, f32 volume, f32 pan, bool loop)
+        -> bool;
+
+    void stop(VoiceId id);
+
+    /** Pan runs from -1 (left) to 1 (right). */
+    void set_volume(VoiceId id, f32 volume, f32 pan);
+
+    void stop_all();
+
+    void set_master_volume(f32 volume) { master_volume_ = volume; }
+
+    /**
+     * Mixes the next output.size() / 2 frames (at most MAX_BLOCK_FRAMES)
+     * into `output` as interleaved left/right samples.
+     */
+    void mix(std::span<s16> output);
+
+    [[nodiscard]] auto active_voices() const -> u32 { return active_count_; }
+
+private:
+    struct Voice {
+        const s16* samples;
+        u32 length;
+        u32 position;
+        f32 gain_left;
+        f32 gain_right;
+        VoiceId id;
+        bool loop;
+    };
+
+    auto find(VoiceId id) -> Voice*;
+
+    std::array<Voice, MAX_VOICES> voices_{};
+    u32 active_count_{0};
+    f32 master_volume_{0.5f};
+
+    alignas(64) std::array<f32, MAX_BLOCK_FRAMES> bus_left_{};
+    alignas(64) std::array<f32, MAX_BLOCK_FRAMES> bus_right_{};
+};
+
+//===========================================================================
+// AudioMixer
+//===========================================================================
+
+/**
+ * Real-time mixer running on its own thread.
+ *
+ * The game thread sends play/stop/volume commands through a lock-free
+ * queue and never waits: when the queue is full the command is dropped
+ * and counted. Every BLOCK_FRAMES (10 ms) the mixing thread applies the
+ * queued commands, mixes one block and hands it to the sink. Device sinks
+ * block until the hardware wants more, other sinks are paced by the thread
+ * itself.
+ */
+class AudioMixer final {
+public:
+    DEFAULT_CTOR(AudioMixer);
+    DELETE_COPY(AudioMixer);
+    DELETE_MOVE(AudioMixer);
+
+    ~AudioMixer();
+
+    static constexpr u32 SAMPLE_RATE = 48000;
+    static constexpr u32 BLOCK_FRAMES = SAMPLE_RATE / 100;
+    static constexpr u32 COMMAND_CAPACITY = 256;
+
+    /**
+     * Starts mixing into `sink`, which must be open and outlive the mixer.
+     * The mix time of every block is recorded into `mix_time` if given.
+     */
+    auto start(AudioSink& sink, metrics::Histogram* mix_time = nullptr)
+        -> bool;
+
+    void stop();
+
+    [[nodiscard]] auto is_running() const -> bool { return running_; }
+
+    /** Returns 0 if the command had to be dropped. */
+    auto play(
+        const Sound& sound,
+        f32 volume = 1.0f,
+        f32 pan = 0.0f,
+        bool loop = false
+    ) -> VoiceId;
+
+    void stop(VoiceId voice);
+    void set_volume(VoiceId voice, f32 volume, f32 pan = 0.0f);
+    void stop_all();
+    void set_master_volume(f32 volume);
+
+    [[nodiscard]] auto commands_dropped() const -> u64
+    {
+        return commands_dropped_.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] auto blocks_mixed() const -> u64
+    {
+        return blocks_mixed_.load(std::memory_order_relaxed);
+    }
+
+private:
+    enum CommandType : u8 {
+        COMMAND_PLAY,
+        COMMAND_STOP,
+        COMMAND_SET_VOLUME,
+        COMMAND_STOP_ALL,
+        COMMAND_MASTER_VOLUME,
+    };
+
+    struct Command {
+        CommandType type;
+        bool loop;
+        VoiceId voice;
+        const s16* samples;
+        u32 length;
+        f32 volume;
+        f32 pan;
+    };
+
+    auto send(const Command& command) -> bool;
+    void apply(const Command& command);
+    void mixer_loop(const std::stop_token& stop_token);
+
+    bool running_{false};
+    VoiceId next_voice_{1};
+    AudioSink* sink_{nullptr};
+    metrics::Histogram* mix_time_{nullptr};
+
+    sync::SpscQueue<Command, COMMAND_CAPACITY> commands_{};
+    std::atomic<u64> commands_dropped_{0};
+    std::atomic<u64> blocks_mixed_{0};
+
+    // owned by the mixing thread while running
+    VoiceMixer voices_{};
+    std::array<s16, BLOCK_FRAMES * 2> block_{};
+
+    std::jthread mixer_{};
+};
+
+} // namespace engine::audio
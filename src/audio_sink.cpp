@@ -0,0 +1,309 @@
+#include "audio_sink.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#if defined(_MSC_FULL_VER)
+#include <mmsystem.h>
+#elif defined(__linux__) && __has_include(<alsa/asoundlib.h>)
+#define ENGINE_AUDIO_ALSA 1
+#include <alsa/asoundlib.h>
+#endif
+
+namespace engine::audio {
+
+namespace {
+
+constexpr u16 CHANNELS = 2;
+constexpr u16 BYTES_PER_FRAME = CHANNELS * sizeof(s16);
+
+// canonical 44 byte header; the sizes are patched in when the file closes
+struct WavHeader {
+    char riff[4];
+    u32 riff_size;
+    char wave[4];
+    char fmt[4];
+    u32 fmt_size;
+    u16 format;
+    u16 channels;
+    u32 sample_rate;
+    u32 byte_rate;
+    u16 block_align;
+    u16 bits_per_sample;
+    char data[4];
+    u32 data_size;
+};
+
+static_assert(sizeof(WavHeader) == 44, "WAV header must not be padded");
+
+} // namespace
+
+//===========================================================================
+// Device backends
+//===========================================================================
+
+#if defined(_MSC_FULL_VER)
+
+/**
+ * waveOut with a few blocks queued; a write waits until the oldest block
+ * has been played.
+ */
+struct AudioSink::Device {
+    static constexpr u32 BUFFERS = 4;
+
+    HWAVEOUT handle{};
+    std::array<WAVEHDR, BUFFERS> headers{};
+    std::vector<s16> samples{};
+    u32 block_samples{0};
+    u32 next{0};
+
+    auto open(u32 sample_rate, u32 block_frames) -> bool
+    {
+        WAVEFORMATEX format{};
+        format.wFormatTag = WAVE_FORMAT_PCM;
+        format.nChannels = CHANNELS;
+        format.nSamplesPerSec = sample_rate;
+        format.wBitsPerSample = 16;
+        format.nBlockAlign = BYTES_PER_FRAME;
+        format.nAvgBytesPerSec = sample_rate * BYTES_PER_FRAME;
+        MMRESULT result =
+            waveOutOpen(&handle, WAVE_MAPPER, &format, 0, 0, CALLBACK_NULL);
+        if (result != MMSYSERR_NOERROR) {
+            return false;
+        }
+
+        block_samples = block_frames * CHANNELS;
+        samples.assign(u64{BUFFERS} * block_samples, 0);
+        for (u32 i = 0; i < BUFFERS; ++i) {
+            WAVEHDR& header = headers[i];
+            header.lpData = reinterpret_cast<LPSTR>(
+                samples.data() + u64{i} * block_samples
+            );
+            header.dwBufferLength = block_samples * sizeof(s16);
+            waveOutPrepareHeader(handle, &header, sizeof(WAVEHDR));
+            // free until it is written for the first time
+            header.dwFlags |= WHDR_DONE;
+        }
+        return true;
+    }
+
+    auto write(std::span<const s16> block) -> bool
+    {
+        WAVEHDR& header = headers[next];
+        while ((header.dwFlags & WHDR_DONE) == 0) {
+            Sleep(1);
+        }
+
+        u64 count = std::min<u64>(block.size(), block_samples);
+        std::copy_n(block.data(), count, reinterpret_cast<s16*>(header.lpData));
+        header.dwBufferLength = static_cast<DWORD>(count * sizeof(s16));
+        header.dwFlags &= ~static_cast<DWORD>(WHDR_DONE);
+        next = (next + 1) % BUFFERS;
+        return waveOutWrite(handle, &header, sizeof(WAVEHDR)) ==
+               MMSYSERR_NOERROR;
+    }
+
+    void close()
+    {
+        waveOutReset(handle);
+        for (auto& header : headers) {
+            waveOutUnprepareHeader(handle, &header, sizeof(WAVEHDR));
+        }
+        waveOutClose(handle);
+    }
+};
+
+#elif defined(ENGINE_AUDIO_ALSA)
+
+/** Blocking ALSA playback; the period is one block. */
+struct AudioSink::Device {
+    snd_pcm_t* pcm{nullptr};
+
+    auto open(u32 sample_rate, u32 block_frames) -> bool
+    {
+        if (snd_pcm_open(&pcm, "default", SND_PCM_STREAM_PLAYBACK, 0) < 0) {
+            return false;
+        }
+
+        // about four blocks of latency
+        auto latency_us = static_cast<unsigned int>(
+            u64{block_frames} * 4 * 1000000 / sample_rate
+        );
+        int result = snd_pcm_set_params(
+            pcm,
+            SND_PCM_FORMAT_S16_LE,
+            SND_PCM_ACCESS_RW_INTERLEAVED,
+            CHANNELS,
+            sample_rate,
+            1,
+            latency_us
+        );
+        if (result < 0) {
+            snd_pcm_close(pcm);
+            return false;
+        }
+        return true;
+    }
+
+    auto write(std::span<const s16> block) -> bool
+    {
+        const s16* data = block.data();
+        auto frames = static_cast<snd_pcm_uframes_t>(block.size() / CHANNELS);
+        while (frames > 0) {
+            snd_pcm_sframes_t written = snd_pcm_writei(pcm, data, frames);
+            if (written < 0) {
+                // recovers from underruns and suspends
+                if (snd_pcm_recover(pcm, static_cast<int>(written), 1) < 0) {
+                    return false;
+                }
+                continue;
+            }
+            data += written * CHANNELS;
+            frames -= static_cast<snd_pcm_uframes_t>(written);
+        }
+        return true;
+    }
+
+    void close()
+    {
+        snd_pcm_drain(pcm);
+        snd_pcm_close(pcm);
+    }
+};
+
+#else
+
+struct AudioSink::Device {
+    auto open(
+        [[maybe_unused]] u32 sample_rate,
+        [[maybe_unused]] u32 block_frames
+    ) -> bool
+    {
+        return false;
+    }
+
+    auto write([[maybe_unused]] std::span<const s16> block) -> bool
+    {
+        return false;
+    }
+
+    void close() {}
+};
+
+#endif
+
+//===========================================================================
+// AudioSink
+//===========================================================================
+
+AudioSink::AudioSink() = default;
+
+AudioSink::~AudioSink()
+{
+    close();
+}
+
+auto AudioSink::open_null(u32 sample_rate) -> bool
+{
+    close();
+    kind_ = SINK_NULL;
+    sample_rate_ = sample_rate;
+    return true;
+}
+
+auto AudioSink::open_wav(const std::filesystem::path& path, u32 sample_rate)
+    -> bool
+{
+    close();
+
+    wav_.open(path, std::ios::binary | std::ios::trunc);
+    if (!wav_) {
+        return false;
+    }
+
+    WavHeader header{
+        {'R', 'I', 'F', 'F'},          // riff
+        0,                             // riff_size
+        {'W', 'A', 'V', 'E'},          // wave
+        {'f', 'm', 't', ' '},          // fmt
+        16,                            // fmt_size
+        1,                             // format (PCM)
+        CHANNELS,                      // channels
+        sample_rate,                   // sample_rate
+        sample_rate * BYTES_PER_FRAME, // byte_rate
+        BYTES_PER_FRAME,               // block_align
+        16,                            // bits_per_sample
+        {'d', 'a', 't', 'a'},          // data
+        0,                             // data_size
+    };
+    wav_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    wav_data_bytes_ = 0;
+    kind_ = SINK_WAV;
+    sample_rate_ = sample_rate;
+    return true;
+}
+
+auto AudioSink::open_device(u32 sample_rate, u32 block_frames) -> bool
+{
+    close();
+
+    auto device = std::make_unique<Device>();
+    if (!device->open(sample_rate, block_frames)) {
+        return false;
+    }
+    device_ = std::move(device);
+    kind_ = SINK_DEVICE;
+    sample_rate_ = sample_rate;
+    return true;
+}
+
+void AudioSink::close()
+{
+    switch (kind_) {
+        case SINK_WAV: {
+            // RIFF sizes are 32 bits; longer recordings keep the maximum
+            auto data_size = static_cast<u32>(
+                std::min<u64>(wav_data_bytes_, 0xffffffffu - 36)
+            );
+            u32 riff_size = data_size + 36;
+            wav_.seekp(offsetof(WavHeader, riff_size));
+            wav_.write(reinterpret_cast<const char*>(&riff_size), 4);
+            wav_.seekp(offsetof(WavHeader, data_size));
+            wav_.write(reinterpret_cast<const char*>(&data_size), 4);
+            wav_.close();
+            break;
+        }
+        case SINK_DEVICE:
+            device_->close();
+            device_.reset();
+            break;
+        default:
+            break;
+    }
+    kind_ = SINK_CLOSED;
+}
+
+auto AudioSink::write(std::span<const s16> samples) -> bool
+{
+    switch (kind_) {
+        case SINK_NULL:
+            return true;
+        case SINK_WAV: {
+            u64 bytes = samples.size() * sizeof(s16);
+            wav_.write(
+                reinterpret_cast<const char*>(samples.data()),
+                static_cast<std::streamsize>(bytes)
+            );
+            wav_data_bytes_ += bytes;
+            return static_cast<bool>(wav_);
+        }
+        case SINK_DEVICE:
+            return device_->write(samples);
+        default:
+            return false;
+    }
+}
+
+} // namespace engine::audio
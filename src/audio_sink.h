@@ -0,0 +1,78 @@
+#pragma once
+
+#include "core.h"
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+
+namespace engine::audio {
+
+enum SinkKind {
+    SINK_CLOSED,
+    /** Discards everything; keeps the mixer running without output. */
+    SINK_NULL,
+    /** 16-bit stereo PCM WAV file. */
+    SINK_WAV,
+    /** Sound card: waveOut on Windows, ALSA on Linux when available. */
+    SINK_DEVICE,
+};
+
+//===========================================================================
+// AudioSink
+//===========================================================================
+
+/**
+ * Destination of the mixed 16-bit stereo samples. Only the mixing thread
+ * writes to a sink.
+ */
+class AudioSink final {
+public:
+    DELETE_COPY(AudioSink);
+    DELETE_MOVE(AudioSink);
+
+    // out of line, Device is only complete in the .cpp
+    AudioSink();
+    ~AudioSink();
+
+    auto open_null(u32 sample_rate) -> bool;
+    auto open_wav(const std::filesystem::path& path, u32 sample_rate)
+        -> bool;
+
+    /**
+     * Opens the default output device, buffering a few blocks of
+     * `block_frames` frames. Fails if there is no device or no backend.
+     */
+    auto open_device(u32 sample_rate, u32 block_frames) -> bool;
+
+    /** Finishes the WAV header or drains the device. */
+    void close();
+
+    /**
+     * Writes interleaved left/right samples. A device sink blocks until
+     * the device has room; the others return immediately.
+     */
+    auto write(std::span<const s16> samples) -> bool;
+
+    /** True if write() keeps real-time pace by itself. */
+    [[nodiscard]] auto paces_itself() const -> bool
+    {
+        return kind_ == SINK_DEVICE;
+    }
+
+    [[nodiscard]] auto kind() const -> SinkKind { return kind_; }
+    [[nodiscard]] auto sample_rate() const -> u32 { return sample_rate_; }
+
+private:
+    struct Device;
+
+    SinkKind kind_{SINK_CLOSED};
+    u32 sample_rate_{0};
+
+    std::ofstream wav_{};
+    u64 wav_data_bytes_{0};
+
+    std::unique_ptr<Device> device_{};
+};
+
+} // namespace engine::audio
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "core.h"
+#include "time.h"
+#include "vecmath.h"
+#include <algorithm>
+#include <bit>
+#include <span>
+
+namespace engine::bullets {
+
+struct Bullet {
+    math::vec2 position;
+    math::vec2 velocity;
+    time::Instant born;
+    /** Cleared when the bullet hits something before it expires. */
+    bool alive;
+};
+
+/**
+ * Fixed capacity ring buffer of bullets.
+ *
+ * All bullets share one lifetime and are spawned in time order, so the
+ * oldest bullet is always at the tail: expiring is just advancing the tail,
+ * and spawning is writing at the head. When the pool is full the oldest
+ * bullet is overwritten. Bullets that hit something are only marked dead
+ * and leave the ring when their time is up.
+ */
+template <u32 Capacity>
+class BulletPool final {
+    static_assert(std::has_single_bit(Capacity), "capacity must be 2^n");
+
+public:
+    DEFAULT_CTOR(BulletPool);
+    DEFAULT_DTOR(BulletPool);
+    DEFAULT_COPY(BulletPool);
+    DEFAULT_MOVE(BulletPool);
+
+    static constexpr u32 CAPACITY = Capacity;
+
+    void clear()
+    {
+        head_ = 0;
+        tail_ = 0;
+    }
+
+    void spawn(math::vec2 position, math::vec2 velocity, time::Instant now)
+    {
+        if (count() == Capacity) {
+            ++tail_;
+        }
+        bullets_[head_++ & MASK] = {position, velocity, now, true};
+    }
+
+    /**
+     * Drops every bullet that is at least `lifetime` old at `now`.
+     */
+    void expire(time::Instant now, time::Duration lifetime)
+    {
+        while (tail_ != head_ &&
+               time::Duration::between(bullets_[tail_ & MASK].born, now) >=
+                   lifetime) {
+            ++tail_;
+        }
+    }
+
+    /**
+     * The live range as (at most) two contiguous runs, oldest first; the
+     * second one is empty unless the range wraps around the buffer end.
+     */
+    struct Segments {
+        std::span<Bullet> first;
+        std::span<Bullet> second;
+    };
+
+    [[nodiscard]] auto segments() -> Segments
+    {
+        u32 begin = tail_ & MASK;
+        u32 first_size = std::min(count(), Capacity - begin);
+        return {
+            {bullets_ + begin, first_size},
+            {bullets_, count() - first_size},
+        };
+    }
+
+    /** Calls `visit(Bullet&)` for every bullet still alive, oldest first. */
+    template <typename Visit>
+    void for_each(Visit&& visit)
+    {
+        auto [first, second] = segments();
+        visit_alive(first, visit);
+        visit_alive(second, visit);
+    }
+
+    [[nodiscard]] auto count() const -> u32 { return head_ - tail_; }
+
+private:
+    static constexpr u32 MASK = Capacity - 1;
+
+    template <typename Visit>
+    static void visit_alive(std::span<Bullet> run, Visit& visit)
+    {
+        for (Bullet& bullet : run) {
+            if (bullet.alive) {
+                visit(bullet);
+            }
+        }
+    }
+
+    Bullet bullets_[Capacity]{};
+    // free running; only the low bits index the buffer
+    u32 head_{0};
+    u32 tail_{0};
+};
+
+} // namespace engine::bullets
@@ -0,0 +1,306 @@
+#include "collision.h"
+#include "simd.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace engine::collision {
+
+using math::vec2;
+
+namespace {
+
+struct Interval {
+    f32 min;
+    f32 max;
+};
+
+/**
+ * Projects the polygon onto an (unnormalized) axis.
+ */
+auto project(const ConvexPolygon& polygon, vec2 axis) -> Interval
+{
+    u32 i = 0;
+    f32 min = std::numeric_limits<f32>::max();
+    f32 max = std::numeric_limits<f32>::lowest();
+
+#if defined(ENGINE_SIMD_SSE2)
+    if (polygon.count >= 4) {
+        const __m128 axis_x = _mm_set1_ps(axis.x);
+        const __m128 axis_y = _mm_set1_ps(axis.y);
+        __m128 min4 = _mm_set1_ps(min);
+        __m128 max4 = _mm_set1_ps(max);
+        for (; i + 4 <= polygon.count; i += 4) {
+            __m128 d = _mm_add_ps(
+                _mm_mul_ps(_mm_loadu_ps(polygon.xs + i), axis_x),
+                _mm_mul_ps(_mm_loadu_ps(polygon.ys + i), axis_y)
+            );
+            min4 = _mm_min_ps(min4, d);
+            max4 = _mm_max_ps(max4, d);
+        }
+
+        alignas(16) f32 mins[4];
+        alignas(16) f32 maxs[4];
+        _mm_store_ps(mins, min4);
+        _mm_store_ps(maxs, max4);
+        min = std::min(std::min(mins[0], mins[1]), std::min(mins[2], mins[3]));
+        max = std::max(std::max(maxs[0], maxs[1]), std::max(maxs[2], maxs[3]));
+    }
+#endif
+
+    for (; i < polygon.count; ++i) {
+        f32 d = polygon.xs[i] * axis.x + polygon.ys[i] * axis.y;
+        min = std::min(min, d);
+        max = std::max(max, d);
+    }
+    return {min, max};
+}
+
+/**
+ * True if one of the edge normals of `polygon` separates the polygons.
+ */
+auto has_separating_axis(
+    const ConvexPolygon& polygon,
+    const ConvexPolygon& other,
+    f32 offset_sign,
+    vec2 offset
+) -> bool
+{
+    u32 previous = polygon.count - 1;
+    for (u32 i = 0; i < polygon.count; ++i) {
+        vec2 edge{
+            polygon.xs[i] - polygon.xs[previous],
+            polygon.ys[i] - polygon.ys[previous],
+        };
+        vec2 axis = math::perpendicular(edge);
+        previous = i;
+
+        // `other` is shifted by offset * offset_sign relative to `polygon`
+        Interval a = project(polygon, axis);
+        Interval b = project(other, axis);
+        f32 shift = math::dot(offset, axis) * offset_sign;
+        if (a.max < b.min + shift || b.max + shift < a.min) {
+            return true;
+        }
+    }
+    return false;
+}
+
+auto vertex(const ConvexPolygon& polygon, u32 i, vec2 offset) -> vec2
+{
+    return {polygon.xs[i] + offset.x, polygon.ys[i] + offset.y};
+}
+
+auto segments_intersect(vec2 p0, vec2 p1, vec2 q0, vec2 q1) -> bool
+{
+    vec2 r = p1 - p0;
+    vec2 s = q1 - q0;
+    f32 d0 = math::cross(r, q0 - p0);
+    f32 d1 = math::cross(r, q1 - p0);
+    f32 d2 = math::cross(s, p0 - q0);
+    f32 d3 = math::cross(s, p1 - q0);
+    if (d0 == 0.0f && d1 == 0.0f && d2 == 0.0f && d3 == 0.0f) {
+        // on a common line the segments meet only if their extents do
+        return std::max(std::min(p0.x, p1.x), std::min(q0.x, q1.x)) <=
+                   std::min(std::max(p0.x, p1.x), std::max(q0.x, q1.x)) &&
+               std::max(std::min(p0.y, p1.y), std::min(q0.y, q1.y)) <=
+                   std::min(std::max(p0.y, p1.y), std::max(q0.y, q1.y));
+    }
+    return ((d0 <= 0.0f && d1 >= 0.0f) || (d0 >= 0.0f && d1 <= 0.0f)) &&
+           ((d2 <= 0.0f && d3 >= 0.0f) || (d2 >= 0.0f && d3 <= 0.0f));
+}
+
+auto contains(const ConvexPolygon& polygon, vec2 offset, vec2 point) -> bool
+{
+    u32 previous = polygon.count - 1;
+    for (u32 i = 0; i < polygon.count; ++i) {
+        vec2 a = vertex(polygon, previous, offset);
+        vec2 b = vertex(polygon, i, offset);
+        if (math::cross(b - a, point - a) < 0.0f) {
+            return false;
+        }
+        previous = i;
+    }
+    return true;
+}
+
+} // namespace
+
+auto convex_hull(std::span<const vec2> points) -> std::vector<vec2>
+{
+    std::vector<vec2> sorted(points.begin(), points.end());
+    std::sort(sorted.begin(), sorted.end(), [](vec2 a, vec2 b) {
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
+    });
+    if (sorted.size() < 3) {
+        return sorted;
+    }
+
+    std::vector<vec2> hull(sorted.size() * 2);
+    u64 k = 0;
+    auto turns_left = [&](vec2 point) {
+        return math::cross(hull[k - 1] - hull[k - 2], point - hull[k - 2]) >
+               0.0f;
+    };
+
+    // lower hull
+    for (auto point : sorted) {
+        while (k >= 2 && !turns_left(point)) {
+            --k;
+        }
+        hull[k++] = point;
+    }
+
+    // upper hull
+    u64 lower_size = k + 1;
+    for (u64 i = sorted.size() - 1; i-- > 0;) {
+        while (k >= lower_size && !turns_left(sorted[i])) {
+            --k;
+        }
+        hull[k++] = sorted[i];
+    }
+
+    // the last point equals the first one
+    hull.resize(k - 1);
+    return hull;
+}
+
+auto polygons_overlap(
+    const ConvexPolygon& a,
+    const ConvexPolygon& b,
+    vec2 offset_b
+) -> bool
+{
+    if (a.count < 3 || b.count < 3) {
+        return false;
+    }
+    return !has_separating_axis(a, b, 1.0f, offset_b) &&
+           !has_separating_axis(b, a, -1.0f, offset_b);
+}
+
+auto polygons_overlap_reference(
+    const ConvexPolygon& a,
+    const ConvexPolygon& b,
+    vec2 offset_b
+) -> bool
+{
+    if (a.count < 3 || b.count < 3) {
+        return false;
+    }
+
+    const vec2 no_offset{0.0f, 0.0f};
+    for (u32 i = 0; i < a.count; ++i) {
+        vec2 p0 = vertex(a, i, no_offset);
+        vec2 p1 = vertex(a, (i + 1) % a.count, no_offset);
+        for (u32 j = 0; j < b.count; ++j) {
+            vec2 q0 = vertex(b, j, offset_b);
+            vec2 q1 = vertex(b, (j + 1) % b.count, offset_b);
+            if (segments_intersect(p0, p1, q0, q1)) {
+                return true;
+            }
+        }
+    }
+
+    return contains(a, no_offset, vertex(b, 0, offset_b)) ||
+           contains(b, offset_b, vertex(a, 0, no_offset));
+}
+
+//===========================================================================
+// NarrowPhase
+//===========================================================================
+
+void NarrowPhase::run(
+    std::span<const Collider> colliders,
+    std::span<const CollisionPair> candidates,
+    world::WorldBounds bounds,
+    std::vector<CollisionPair>& hits
+)
+{
+    auto width = static_cast<f32>(bounds.width);
+    auto height = static_cast<f32>(bounds.height);
+    circle_survivors_ = 0;
+
+    for (u64 first = 0; first < candidates.size(); first += BATCH_SIZE) {
+        u64 batch_size = std::min<u64>(BATCH_SIZE, candidates.size() - first);
+
+        // gather the bounding circles of the batch into SoA form; unused
+        // lanes get a negative radius so that they never pass
+        alignas(16) f32 dx[BATCH_SIZE] = {};
+        alignas(16) f32 dy[BATCH_SIZE] = {};
+        alignas(16) f32 reach[BATCH_SIZE] = {-1.0f, -1.0f, -1.0f, -1.0f};
+        for (u64 i = 0; i < batch_size; ++i) {
+            const auto& pair = candidates[first + i];
+            const auto& a = colliders[pair.a];
+            const auto& b = colliders[pair.b];
+            dx[i] = b.center.x - a.center.x;
+            dy[i] = b.center.y - a.center.y;
+            reach[i] = a.radius + b.radius;
+        }
+
+        // wrap the deltas to the shortest displacement across the seams and
+        // test all circles of the batch at once
+        alignas(16) f32 shift_x[BATCH_SIZE];
+        alignas(16) f32 shift_y[BATCH_SIZE];
+        u32 passed = 0;
+
+#if defined(ENGINE_SIMD_SSE2)
+        {
+            __m128 w = _mm_set1_ps(width);
+            __m128 h = _mm_set1_ps(height);
+            __m128 x = _mm_load_ps(dx);
+            __m128 y = _mm_load_ps(dy);
+            __m128 sx = _mm_mul_ps(
+                w,
+                _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_div_ps(x, w)))
+            );
+            __m128 sy = _mm_mul_ps(
+                h,
+                _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_div_ps(y, h)))
+            );
+            x = _mm_sub_ps(x, sx);
+            y = _mm_sub_ps(y, sy);
+
+            __m128 r = _mm_load_ps(reach);
+            __m128 distance = _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y));
+            __m128 inside = _mm_and_ps(
+                _mm_cmple_ps(distance, _mm_mul_ps(r, r)),
+                _mm_cmpge_ps(r, _mm_setzero_ps())
+            );
+            passed = static_cast<u32>(_mm_movemask_ps(inside));
+
+            _mm_store_ps(shift_x, _mm_sub_ps(_mm_setzero_ps(), sx));
+            _mm_store_ps(shift_y, _mm_sub_ps(_mm_setzero_ps(), sy));
+        }
+#else
+        for (u32 i = 0; i < BATCH_SIZE; ++i) {
+            shift_x[i] = -width * std::nearbyint(dx[i] / width);
+            shift_y[i] = -height * std::nearbyint(dy[i] / height);
+            f32 x = dx[i] + shift_x[i];
+            f32 y = dy[i] + shift_y[i];
+            bool inside =
+                reach[i] >= 0.0f && x * x + y * y <= reach[i] * reach[i];
+            passed |= static_cast<u32>(inside) << i;
+        }
+#endif
+
+        // exact test for the survivors only
+        for (u32 i = 0; i < batch_size; ++i) {
+            if ((passed & (1u << i)) == 0) {
+                continue;
+            }
+            ++circle_survivors_;
+
+            const auto& pair = candidates[first + i];
+            vec2 offset{shift_x[i], shift_y[i]};
+            if (polygons_overlap(
+                    colliders[pair.a].polygon,
+                    colliders[pair.b].polygon,
+                    offset
+                )) {
+                hits.push_back(pair);
+            }
+        }
+    }
+}
+
+} // namespace engine::collision
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "core.h"
+#include "vecmath.h"
+#include "world.h"
+#include <span>
+#include <vector>
+
+namespace engine::collision {
+
+/**
+ * Convex polygon in world space; vertices in counter-clockwise order and
+ * stored as structure of arrays. Outlines with fewer than three vertices
+ * have no area and never overlap anything.
+ */
+struct ConvexPolygon {
+    const f32* xs;
+    const f32* ys;
+    u32 count;
+};
+
+/**
+ * Collision shape of a single object: a bounding circle for the early-out
+ * and the exact convex outline.
+ */
+struct Collider {
+    math::vec2 center;
+    f32 radius;
+    ConvexPolygon polygon;
+};
+
+/** Indices of two colliders. */
+struct CollisionPair {
+    u32 a;
+    u32 b;
+};
+
+/**
+ * Convex hull of a point set (Andrew's monotone chain) in counter-clockwise
+ * order; used to turn jagged outlines into collision shapes at load time.
+ */
+auto convex_hull(std::span<const math::vec2> points) -> std::vector<math::vec2>;
+
+/**
+ * Separating axis test. Polygon b is translated by `offset_b` before the
+ * test, which is how overlaps across the world seams are handled.
+ */
+auto polygons_overlap(
+    const ConvexPolygon& a,
+    const ConvexPolygon& b,
+    math::vec2 offset_b
+) -> bool;
+
+/**
+ * Brute force reference for polygons_overlap(): tests every edge pair for
+ * intersection plus containment of one polygon in the other. Meant for
+ * validation only.
+ */
+auto polygons_overlap_reference(
+    const ConvexPolygon& a,
+    const ConvexPolygon& b,
+    math::vec2 offset_b
+) -> bool;
+
+//===========================================================================
+// NarrowPhase
+//===========================================================================
+
+/**
+ * Exact overlap tests for candidate pairs produced by a broadphase.
+ *
+ * Pairs are processed in batches: the bounding circles of a batch are
+ * gathered into structure-of-arrays form and tested with SIMD first, and
+ * only the survivors go through the separating axis test. All distances are
+ * measured across the toroidal world, so hits across the seams are found.
+ */
+class NarrowPhase final {
+public:
+    DEFAULT_CTOR(NarrowPhase);
+    DEFAULT_DTOR(NarrowPhase);
+    DELETE_COPY(NarrowPhase);
+    DEFAULT_MOVE(NarrowPhase);
+
+    static constexpr u32 BATCH_SIZE = 4;
+
+    /**
+     * Appends every overlapping candidate pair to `hits`.
+     */
+    void run(
+        std::span<const Collider> colliders,
+        std::span<const CollisionPair> candidates,
+        world::WorldBounds bounds,
+        std::vector<CollisionPair>& hits
+    );
+
+    /** Number of pairs that passed the circle test during the last run. */
+    [[nodiscard]] auto circle_survivors() const -> u32
+    {
+        return circle_survivors_;
+    }
+
+private:
+    u32 circle_survivors_{0};
+};
+
+} // namespace engine::collision
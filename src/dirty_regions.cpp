@@ -0,0 +1,75 @@
+#include "dirty_regions.h"
+#include <algorithm>
+
+namespace engine::graphics {
+
+auto DirtyRegions::tracks(const ScreenBuffer& screen_buffer) const -> bool
+{
+    return buffer_ == screen_buffer.pixels && width_ == screen_buffer.width &&
+           height_ == screen_buffer.height;
+}
+
+auto DirtyRegions::erase(ScreenBuffer& screen_buffer, ARGB color) -> bool
+{
+    if (!tracks(screen_buffer) || overflow_) {
+        clear(screen_buffer, color);
+        return false;
+    }
+
+    auto width = static_cast<u64>(width_);
+    for (const Rect& rect : rects_) {
+        auto columns = static_cast<u64>(rect.right - rect.left);
+        for (s32 y = rect.top; y < rect.bottom; ++y) {
+            ARGB* row = screen_buffer.pixels + static_cast<u64>(y) * width;
+            std::fill_n(row + rect.left, columns, color);
+        }
+    }
+    for (u64 index : pixels_) {
+        screen_buffer.pixels[index] = color;
+    }
+
+    reset(screen_buffer);
+    return true;
+}
+
+void DirtyRegions::clear(ScreenBuffer& screen_buffer, ARGB color)
+{
+    screen_buffer_fill(screen_buffer, color);
+    reset(screen_buffer);
+}
+
+void DirtyRegions::mark(Rect rect)
+{
+    if (overflow_) {
+        return;
+    }
+
+    rect.left = std::max(rect.left, 0);
+    rect.top = std::max(rect.top, 0);
+    rect.right = std::min(rect.right, width_);
+    rect.bottom = std::min(rect.bottom, height_);
+    if (rect.left >= rect.right || rect.top >= rect.bottom) {
+        return;
+    }
+
+    rects_.push_back(rect);
+    add_area(
+        static_cast<u64>(rect.right - rect.left) *
+        static_cast<u64>(rect.bottom - rect.top)
+    );
+}
+
+void DirtyRegions::reset(const ScreenBuffer& screen_buffer)
+{
+    buffer_ = screen_buffer.pixels;
+    width_ = screen_buffer.width;
+    height_ = screen_buffer.height;
+
+    rects_.clear();
+    pixels_.clear();
+    area_ = 0;
+    area_limit_ = screen_buffer.pixels_size * FULL_CLEAR_PERCENT / 100;
+    overflow_ = false;
+}
+
+} // namespace engine::graphics
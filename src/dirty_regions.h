@@ -0,0 +1,96 @@
+#pragma once
+
+#include "core.h"
+#include "graphics.h"
+#include <vector>
+
+namespace engine::graphics {
+
+/** Pixel rectangle; `right` and `bottom` are exclusive. */
+struct Rect {
+    s32 left;
+    s32 top;
+    s32 right;
+    s32 bottom;
+};
+
+//===========================================================================
+// DirtyRegions
+//===========================================================================
+
+/**
+ * Records which pixels of a buffer a frame drew, so that the next frame
+ * can erase just those instead of clearing the whole buffer.
+ *
+ * Drawing code marks the rectangles and single pixels it writes; erase()
+ * resets what the previous frame marked and starts a new record. The cost
+ * of a frame then follows what is on screen rather than the resolution.
+ * When the marked area grows beyond FULL_CLEAR_PERCENT of the buffer, or
+ * erase() is handed a different buffer than last time, it clears
+ * everything instead.
+ *
+ * The record only grows; once warmed up a frame does no allocations.
+ */
+class DirtyRegions final {
+public:
+    DEFAULT_CTOR(DirtyRegions);
+    DEFAULT_DTOR(DirtyRegions);
+    DELETE_COPY(DirtyRegions);
+    DEFAULT_MOVE(DirtyRegions);
+
+    /** Share of the buffer above which a full clear is cheaper. */
+    static constexpr u64 FULL_CLEAR_PERCENT = 50;
+
+    /** True if the record belongs to this buffer. */
+    [[nodiscard]] auto tracks(const ScreenBuffer& screen_buffer) const
+        -> bool;
+
+    /**
+     * Erases what was marked since the last erase of this buffer and
+     * starts recording the new frame. Returns false if the whole buffer
+     * had to be cleared.
+     */
+    auto erase(ScreenBuffer& screen_buffer, ARGB color) -> bool;
+
+    /** Clears the whole buffer and starts recording the new frame. */
+    void clear(ScreenBuffer& screen_buffer, ARGB color);
+
+    /**
+     * Starts recording the new frame without erasing anything, for when
+     * the caller repainted the whole buffer itself.
+     */
+    void reset(const ScreenBuffer& screen_buffer);
+
+    /** Marks a rectangle; it is clipped against the buffer. */
+    void mark(Rect rect);
+
+    /** Marks a single pixel by its index into the buffer. */
+    void mark_pixel(u64 index)
+    {
+        if (!overflow_) {
+            pixels_.push_back(index);
+            add_area(1);
+        }
+    }
+
+private:
+    void add_area(u64 area)
+    {
+        area_ += area;
+        overflow_ = area_ > area_limit_;
+    }
+
+    // identifies the tracked buffer
+    const ARGB* buffer_{nullptr};
+    s32 width_{0};
+    s32 height_{0};
+
+    std::vector<Rect> rects_{};
+    std::vector<u64> pixels_{};
+    u64 area_{0};
+    u64 area_limit_{0};
+    // set once the record got too large to be worth erasing piecewise
+    bool overflow_{false};
+};
+
+} // namespace engine::graphics
@@ -0,0 +1,429 @@
+#include "frame_capture.h"
+#include "simd.h"
+#include <cstring>
+#include <format>
+
+namespace engine::capture {
+
+using graphics::ARGB;
+using graphics::ScreenBuffer;
+
+//===========================================================================
+// YUV conversion
+//===========================================================================
+
+namespace {
+
+constexpr char FRAME_TAG[] = "FRAME\n";
+constexpr u64 FRAME_TAG_SIZE = sizeof(FRAME_TAG) - 1;
+
+// BT.601 limited range coefficients in 8.8 fixed point
+constexpr auto luma(s32 r, s32 g, s32 b) -> u8
+{
+    return static_cast<u8>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+constexpr auto chroma_u(s32 r, s32 g, s32 b) -> u8
+{
+    return static_cast<u8>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+}
+
+constexpr auto chroma_v(s32 r, s32 g, s32 b) -> u8
+{
+    return static_cast<u8>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+
+/**
+ * Scalar reference; converts columns [x_begin, width) of a row pair.
+ */
+void yuv420_row_pair_scalar(
+    const ARGB* row0,
+    const ARGB* row1,
+    s32 x_begin,
+    s32 width,
+    u8* y_row0,
+    u8* y_row1,
+    u8* u_row,
+    u8* v_row
+)
+{
+    for (s32 x = x_begin; x < width; x += 2) {
+        s32 r = 0;
+        s32 g = 0;
+        s32 b = 0;
+        for (s32 i = 0; i < 2; ++i) {
+            const auto& top = row0[x + i].colors;
+            const auto& bottom = row1[x + i].colors;
+            y_row0[x + i] = luma(top.red, top.green, top.blue);
+            y_row1[x + i] = luma(bottom.red, bottom.green, bottom.blue);
+            r += top.red + bottom.red;
+            g += top.green + bottom.green;
+            b += top.blue + bottom.blue;
+        }
+        r = (r + 2) >> 2;
+        g = (g + 2) >> 2;
+        b = (b + 2) >> 2;
+        u_row[x / 2] = chroma_u(r, g, b);
+        v_row[x / 2] = chroma_v(r, g, b);
+    }
+}
+
+#if defined(ENGINE_SIMD_SSE2)
+
+/**
+ * Splits 8 BGRA pixels into 16-bit blue, green and red lanes.
+ */
+inline void unpack_bgr(
+    const ARGB* pixels,
+    __m128i& blue,
+    __m128i& green,
+    __m128i& red
+)
+{
+    const __m128i mask = _mm_set1_epi32(0xff);
+    __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+    __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + 4));
+
+    blue = _mm_packs_epi32(_mm_and_si128(lo, mask), _mm_and_si128(hi, mask));
+    green = _mm_packs_epi32(
+        _mm_and_si128(_mm_srli_epi32(lo, 8), mask),
+        _mm_and_si128(_mm_srli_epi32(hi, 8), mask)
+    );
+    red = _mm_packs_epi32(
+        _mm_and_si128(_mm_srli_epi32(lo, 16), mask),
+        _mm_and_si128(_mm_srli_epi32(hi, 16), mask)
+    );
+}
+
+/**
+ * Computes 8 luma values; the weighted sum fits into unsigned 16 bits.
+ */
+inline auto luma_x8(__m128i blue, __m128i green, __m128i red) -> __m128i
+{
+    __m128i sum = _mm_add_epi16(
+        _mm_add_epi16(
+            _mm_mullo_epi16(red, _mm_set1_epi16(66)),
+            _mm_mullo_epi16(green, _mm_set1_epi16(129))
+        ),
+        _mm_add_epi16(
+            _mm_mullo_epi16(blue, _mm_set1_epi16(25)),
+            _mm_set1_epi16(128)
+        )
+    );
+    return _mm_add_epi16(_mm_srli_epi16(sum, 8), _mm_set1_epi16(16));
+}
+
+/**
+ * Averages horizontal pairs of the (already vertically summed) components;
+ * the 4 results end up in the low half as 16-bit lanes.
+ */
+inline auto average_2x2(__m128i vertical_sum) -> __m128i
+{
+    __m128i sum = _mm_madd_epi16(vertical_sum, _mm_set1_epi16(1));
+    sum = _mm_srli_epi32(_mm_add_epi32(sum, _mm_set1_epi32(2)), 2);
+    return _mm_packs_epi32(sum, _mm_setzero_si128());
+}
+
+/**
+ * Computes signed chroma; the weighted sum fits into signed 16 bits.
+ */
+inline auto chroma_x4(
+    __m128i blue,
+    __m128i green,
+    __m128i red,
+    s16 red_weight,
+    s16 green_weight,
+    s16 blue_weight
+) -> __m128i
+{
+    __m128i sum = _mm_add_epi16(
+        _mm_add_epi16(
+            _mm_mullo_epi16(red, _mm_set1_epi16(red_weight)),
+            _mm_mullo_epi16(green, _mm_set1_epi16(green_weight))
+        ),
+        _mm_add_epi16(
+            _mm_mullo_epi16(blue, _mm_set1_epi16(blue_weight)),
+            _mm_set1_epi16(128)
+        )
+    );
+    return _mm_add_epi16(_mm_srai_epi16(sum, 8), _mm_set1_epi16(128));
+}
+
+inline void store_4_bytes(u8* target, __m128i words)
+{
+    auto value = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+    std::memcpy(target, &value, 4);
+}
+
+/**
+ * Converts 8 columns of a row pair per iteration; returns the first column
+ * left for the scalar tail.
+ */
+auto yuv420_row_pair_sse2(
+    const ARGB* row0,
+    const ARGB* row1,
+    s32 width,
+    u8* y_row0,
+    u8* y_row1,
+    u8* u_row,
+    u8* v_row
+) -> s32
+{
+    s32 x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m128i b0, g0, r0;
+        __m128i b1, g1, r1;
+        unpack_bgr(row0 + x, b0, g0, r0);
+        unpack_bgr(row1 + x, b1, g1, r1);
+
+        __m128i y0 = luma_x8(b0, g0, r0);
+        __m128i y1 = luma_x8(b1, g1, r1);
+        _mm_storel_epi64(
+            reinterpret_cast<__m128i*>(y_row0 + x),
+            _mm_packus_epi16(y0, y0)
+        );
+        _mm_storel_epi64(
+            reinterpret_cast<__m128i*>(y_row1 + x),
+            _mm_packus_epi16(y1, y1)
+        );
+
+        __m128i blue = average_2x2(_mm_add_epi16(b0, b1));
+        __m128i green = average_2x2(_mm_add_epi16(g0, g1));
+        __m128i red = average_2x2(_mm_add_epi16(r0, r1));
+        __m128i u = chroma_x4(blue, green, red, -38, -74, 112);
+        __m128i v = chroma_x4(blue, green, red, 112, -94, -18);
+        store_4_bytes(u_row + x / 2, u);
+        store_4_bytes(v_row + x / 2, v);
+    }
+    return x;
+}
+
+#endif // ENGINE_SIMD_SSE2
+
+} // namespace
+
+void argb_to_yuv420(
+    const ARGB* pixels,
+    s32 width,
+    s32 height,
+    s32 stride,
+    u8* y_plane,
+    u8* u_plane,
+    u8* v_plane
+)
+{
+    s32 chroma_width = width / 2;
+    for (s32 y = 0; y < height; y += 2) {
+        const ARGB* row0 = pixels + static_cast<s64>(y) * stride;
+        const ARGB* row1 = row0 + stride;
+        u8* y_row0 = y_plane + static_cast<s64>(y) * width;
+        u8* y_row1 = y_row0 + width;
+        u8* u_row = u_plane + static_cast<s64>(y / 2) * chroma_width;
+        u8* v_row = v_plane + static_cast<s64>(y / 2) * chroma_width;
+
+        s32 x = 0;
+#if defined(ENGINE_SIMD_SSE2)
+        x = yuv420_row_pair_sse2(
+            row0,
+            row1,
+            width,
+            y_row0,
+            y_row1,
+            u_row,
+            v_row
+        );
+#endif
+        yuv420_row_pair_scalar(
+            row0,
+            row1,
+            x,
+            width,
+            y_row0,
+            y_row1,
+            u_row,
+            v_row
+        );
+    }
+}
+
+//===========================================================================
+// FrameCapture
+//===========================================================================
+
+FrameCapture::~FrameCapture()
+{
+    stop();
+}
+
+auto FrameCapture::start(
+    const std::filesystem::path& path,
+    s32 width,
+    s32 height,
+    u32 frames_per_second
+) -> bool
+{
+    if (running_) {
+        return false;
+    }
+
+    width_ = width & ~1;
+    height_ = height & ~1;
+    if (width_ <= 0 || height_ <= 0) {
+        return false;
+    }
+
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_) {
+        return false;
+    }
+
+    auto header = std::format(
+        "YUV4MPEG2 W{} H{} F{}:1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n",
+        width_,
+        height_,
+        frames_per_second
+    );
+    file_.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+    // all memory is allocated up front; a frame is written with one call
+    frame_pixels_ = static_cast<u64>(width_) * static_cast<u64>(height_);
+    pool_.assign(frame_pixels_ * POOL_SIZE, ARGB{});
+    frame_bytes_.assign(FRAME_TAG_SIZE + frame_pixels_ * 3 / 2, 0);
+    std::memcpy(frame_bytes_.data(), FRAME_TAG, FRAME_TAG_SIZE);
+
+    for (u32 slot = 0; slot < POOL_SIZE; ++slot) {
+        free_slots_.try_push(slot);
+    }
+
+    frames_written_ = 0;
+    frames_dropped_ = 0;
+    running_ = true;
+    writer_ = std::jthread([this](std::stop_token stop_token) {
+        writer_loop(stop_token);
+    });
+
+    return true;
+}
+
+void FrameCapture::stop()
+{
+    if (!running_) {
+        return;
+    }
+
+    writer_.request_stop();
+    signal_.fetch_add(1, std::memory_order_release);
+    signal_.notify_one();
+    writer_.join();
+
+    // return the slots so that the capture can be restarted
+    u32 slot{};
+    while (free_slots_.try_pop(slot)) {
+    }
+
+    file_.close();
+    running_ = false;
+
+    DEBUG_PRINT(std::format(
+                    "capture stopped: {} frames written, {} frames dropped\n",
+                    frames_written(),
+                    frames_dropped()
+    )
+                    .c_str());
+}
+
+auto FrameCapture::submit(const ScreenBuffer& screen_buffer) -> bool
+{
+    if (!running_) {
+        return false;
+    }
+
+    u32 slot{};
+    if (screen_buffer.width < width_ || screen_buffer.height < height_ ||
+        !free_slots_.try_pop(slot)) {
+        frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    ARGB* target = pool_.data() + slot * frame_pixels_;
+    if (screen_buffer.width == width_) {
+        std::memcpy(
+            target,
+            screen_buffer.pixels,
+            frame_pixels_ * sizeof(ARGB)
+        );
+    } else {
+        for (s32 y = 0; y < height_; ++y) {
+            std::memcpy(
+                target + static_cast<s64>(y) * width_,
+                screen_buffer.pixels +
+                    static_cast<s64>(y) * screen_buffer.width,
+                static_cast<u64>(width_) * sizeof(ARGB)
+            );
+        }
+    }
+
+    // the writer owns the pool buffers, so a push always succeeds
+    filled_slots_.try_push(slot);
+    signal_.fetch_add(1, std::memory_order_release);
+    signal_.notify_one();
+    return true;
+}
+
+auto FrameCapture::frames_written() const -> u64
+{
+    return frames_written_.load(std::memory_order_relaxed);
+}
+
+auto FrameCapture::frames_dropped() const -> u64
+{
+    return frames_dropped_.load(std::memory_order_relaxed);
+}
+
+void FrameCapture::writer_loop(const std::stop_token& stop_token)
+{
+    while (true) {
+        u32 seen = signal_.load(std::memory_order_acquire);
+
+        u32 slot{};
+        if (filled_slots_.try_pop(slot)) {
+            write_frame(slot);
+            continue;
+        }
+
+        // only stop once everything submitted so far has been written
+        if (stop_token.stop_requested()) {
+            break;
+        }
+
+        signal_.wait(seen, std::memory_order_acquire);
+    }
+}
+
+void FrameCapture::write_frame(u32 slot)
+{
+    u8* y_plane = frame_bytes_.data() + FRAME_TAG_SIZE;
+    u8* u_plane = y_plane + frame_pixels_;
+    u8* v_plane = u_plane + frame_pixels_ / 4;
+
+    argb_to_yuv420(
+        pool_.data() + slot * frame_pixels_,
+        width_,
+        height_,
+        width_,
+        y_plane,
+        u_plane,
+        v_plane
+    );
+
+    // the pixels have been consumed; recycle the buffer before hitting disk
+    free_slots_.try_push(slot);
+
+    file_.write(
+        reinterpret_cast<const char*>(frame_bytes_.data()),
+        static_cast<std::streamsize>(frame_bytes_.size())
+    );
+    frames_written_.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace engine::capture
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "core.h"
+#include "graphics.h"
+#include "spsc_queue.h"
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+namespace engine::capture {
+
+/**
+ * Converts 32-bit BGRA pixels into planar 8-bit YUV 4:2:0 (BT.601, limited
+ * range). Width and height must be even; chroma is averaged over each 2x2
+ * block.
+ */
+void argb_to_yuv420(
+    const graphics::ARGB* pixels,
+    s32 width,
+    s32 height,
+    s32 stride,
+    u8* y_plane,
+    u8* u_plane,
+    u8* v_plane
+);
+
+//===========================================================================
+// FrameCapture
+//===========================================================================
+
+/**
+ * Records screen buffer contents into a Y4M file on a background thread.
+ *
+ * Frames travel between the game thread and the writer thread through a
+ * fixed pool of pre-allocated buffers; no allocations happen per frame. The
+ * game thread never waits for the writer: when no buffer is free the frame
+ * is dropped and counted.
+ */
+class FrameCapture final {
+public:
+    DEFAULT_CTOR(FrameCapture);
+    DELETE_COPY(FrameCapture);
+    DELETE_MOVE(FrameCapture);
+
+    ~FrameCapture();
+
+    /** Number of frames that can be in flight at once. */
+    static constexpr u32 POOL_SIZE = 8;
+
+    /**
+     * Creates the output file and starts the writer thread. Odd dimensions
+     * are cropped by one pixel since 4:2:0 needs even dimensions.
+     */
+    auto start(
+        const std::filesystem::path& path,
+        s32 width,
+        s32 height,
+        u32 frames_per_second
+    ) -> bool;
+
+    /** Flushes queued frames and stops the writer thread. */
+    void stop();
+
+    /**
+     * Copies the screen buffer into a free pool buffer and hands it to the
+     * writer thread. Returns false when the frame had to be dropped.
+     */
+    auto submit(const graphics::ScreenBuffer& screen_buffer) -> bool;
+
+    [[nodiscard]] auto is_running() const -> bool { return running_; }
+    [[nodiscard]] auto frames_written() const -> u64;
+    [[nodiscard]] auto frames_dropped() const -> u64;
+
+private:
+    void writer_loop(const std::stop_token& stop_token);
+    void write_frame(u32 slot);
+
+    bool running_{false};
+    s32 width_{0};
+    s32 height_{0};
+    u64 frame_pixels_{0};
+
+    std::vector<graphics::ARGB> pool_{};
+    sync::SpscQueue<u32, POOL_SIZE> free_slots_{};
+    sync::SpscQueue<u32, POOL_SIZE> filled_slots_{};
+    std::atomic<u32> signal_{0};
+
+    std::atomic<u64> frames_written_{0};
+    std::atomic<u64> frames_dropped_{0};
+
+    // owned by the writer thread while running
+    std::vector<u8> frame_bytes_{};
+    std::ofstream file_{};
+
+    std::jthread writer_{};
+};
+
+} // namespace engine::capture
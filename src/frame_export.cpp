@@ -0,0 +1,220 @@
+#include "frame_export.h"
+#include "time.h"
+#include <algorithm>
+#include <cstring>
+
+namespace engine::capture {
+
+namespace {
+
+auto slot_pixels(const FrameExportHeader& header, u32 slot) -> u64
+{
+    return header.slot_offset + header.slot_size * slot;
+}
+
+} // namespace
+
+//===========================================================================
+// FrameExport
+//===========================================================================
+
+FrameExport::~FrameExport()
+{
+    stop();
+}
+
+auto FrameExport::start(
+    std::string_view name,
+    s32 width,
+    s32 height,
+    u32 slot_count
+) -> bool
+{
+    stop();
+
+    slot_count = std::clamp(slot_count, 2u, FrameExportHeader::MAX_SLOTS);
+    u64 stride = static_cast<u64>(width) * sizeof(graphics::ARGB);
+    u64 slot_size = memory::align_up(
+        stride * static_cast<u64>(height),
+        memory::STANDARD_PAGE_SIZE
+    );
+    u64 size = memory::STANDARD_PAGE_SIZE + slot_size * slot_count;
+
+    mapping_ = memory::create_shared_memory(name, size);
+    if (mapping_.data == nullptr) {
+        return false;
+    }
+    name_ = name;
+    next_frame_ = 1;
+
+    // readers check the magic last; an older export of the same name may
+    // still be mapped by them
+    FrameExportHeader& h = header();
+    h.magic = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+    h.version = FrameExportHeader::VERSION;
+    h.format = graphics::PixelFormat::BGRA32;
+    h.slot_count = slot_count;
+    h.width = width;
+    h.height = height;
+    h.stride = stride;
+    h.slot_offset = memory::STANDARD_PAGE_SIZE;
+    h.slot_size = slot_size;
+    h.latest_frame.store(0, std::memory_order_relaxed);
+    for (auto& slot : h.slots) {
+        slot.sequence.store(0, std::memory_order_relaxed);
+        slot.frame_number = 0;
+        slot.timestamp_ns = 0;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    h.magic = FrameExportHeader::MAGIC;
+    return true;
+}
+
+void FrameExport::stop()
+{
+    memory::release_shared_memory(mapping_, name_);
+    name_.clear();
+}
+
+auto FrameExport::header() -> FrameExportHeader&
+{
+    return *static_cast<FrameExportHeader*>(mapping_.data);
+}
+
+auto FrameExport::begin_frame() -> graphics::ARGB*
+{
+    FrameExportHeader& h = header();
+    slot_ = static_cast<u32>(next_frame_ % h.slot_count);
+
+    FrameSlot& slot = h.slots[slot_];
+    u64 sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    auto* base = static_cast<u8*>(mapping_.data);
+    return reinterpret_cast<graphics::ARGB*>(base + slot_pixels(h, slot_));
+}
+
+void FrameExport::end_frame()
+{
+    FrameExportHeader& h = header();
+    FrameSlot& slot = h.slots[slot_];
+    slot.frame_number = next_frame_;
+    slot.timestamp_ns = time::Instant::now().nanosecond_value();
+
+    u64 sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_release);
+    h.latest_frame.store(next_frame_++, std::memory_order_release);
+}
+
+//===========================================================================
+// FrameReader
+//===========================================================================
+
+FrameReader::~FrameReader()
+{
+    close();
+}
+
+auto FrameReader::open(std::string_view name) -> bool
+{
+    close();
+
+    mapping_ = memory::open_shared_memory(name);
+    if (mapping_.data == nullptr) {
+        return false;
+    }
+    name_ = name;
+
+    const FrameExportHeader& h = header();
+    bool valid = mapping_.size >= memory::STANDARD_PAGE_SIZE &&
+                 h.magic == FrameExportHeader::MAGIC &&
+                 h.version == FrameExportHeader::VERSION &&
+                 h.slot_count > 0 &&
+                 h.slot_count <= FrameExportHeader::MAX_SLOTS &&
+                 slot_pixels(h, h.slot_count) <= mapping_.size;
+    if (!valid) {
+        close();
+    }
+    return valid;
+}
+
+void FrameReader::close()
+{
+    memory::release_shared_memory(mapping_, name_);
+    name_.clear();
+}
+
+auto FrameReader::header() const -> const FrameExportHeader&
+{
+    return *static_cast<const FrameExportHeader*>(mapping_.data);
+}
+
+auto FrameReader::acquire(u64 after, FrameView& view) const -> bool
+{
+    const FrameExportHeader& h = header();
+    u64 latest = h.latest_frame.load(std::memory_order_acquire);
+    if (latest <= after) {
+        return false;
+    }
+
+    auto slot_index = static_cast<u32>(latest % h.slot_count);
+    const FrameSlot& slot = h.slots[slot_index];
+    u64 sequence = slot.sequence.load(std::memory_order_acquire);
+    if ((sequence & 1) != 0) {
+        // the writer came around the ring already
+        return false;
+    }
+
+    const auto* base = static_cast<const u8*>(mapping_.data);
+    view = {
+        reinterpret_cast<const graphics::ARGB*>(
+            base + slot_pixels(h, slot_index)
+        ),                 // pixels
+        h.width,           // width
+        h.height,          // height
+        h.stride,          // stride
+        slot.frame_number, // frame_number
+        slot.timestamp_ns, // timestamp_ns
+        slot_index,        // slot
+        sequence,          // sequence
+    };
+    return validate(view);
+}
+
+auto FrameReader::validate(const FrameView& view) const -> bool
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const FrameSlot& slot = header().slots[view.slot];
+    return slot.sequence.load(std::memory_order_relaxed) == view.sequence;
+}
+
+auto FrameReader::read(
+    u64 after,
+    std::span<graphics::ARGB> pixels,
+    FrameView& view
+) const -> bool
+{
+    if (!acquire(after, view)) {
+        return false;
+    }
+
+    auto width = static_cast<u64>(view.width);
+    auto height = static_cast<u64>(view.height);
+    if (pixels.size() < width * height) {
+        return false;
+    }
+
+    const auto* source = reinterpret_cast<const u8*>(view.pixels);
+    for (u64 y = 0; y < height; ++y) {
+        std::memcpy(
+            pixels.data() + y * width,
+            source + y * view.stride,
+            width * sizeof(graphics::ARGB)
+        );
+    }
+    return validate(view);
+}
+
+} // namespace engine::capture
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "core.h"
+#include "graphics.h"
+#include "pixel_format.h"
+#include "shared_memory.h"
+#include <atomic>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace engine::capture {
+
+//===========================================================================
+// Shared layout
+//===========================================================================
+
+/**
+ * Bookkeeping of one frame of the ring. The sequence is odd while the game
+ * is drawing into the slot.
+ */
+struct FrameSlot {
+    std::atomic<u64> sequence;
+    u64 frame_number;
+    u64 timestamp_ns;
+    u64 reserved;
+};
+
+/**
+ * Start of an exported frame segment. The header takes the first page; the
+ * pixels of slot i start at slot_offset + i * slot_size and are page
+ * aligned.
+ */
+struct FrameExportHeader {
+    static constexpr u32 MAGIC = 0x454d5246; // "FRME"
+    static constexpr u32 VERSION = 1;
+    static constexpr u32 MAX_SLOTS = 8;
+
+    u32 magic;
+    u32 version;
+    graphics::PixelFormat format;
+    u32 slot_count;
+    s32 width;
+    s32 height;
+    /** Bytes from one row to the next. */
+    u64 stride;
+    u64 slot_offset;
+    u64 slot_size;
+    /** Number of the newest complete frame; zero before the first one. */
+    std::atomic<u64> latest_frame;
+    FrameSlot slots[MAX_SLOTS];
+};
+
+static_assert(
+    sizeof(FrameExportHeader) <= memory::STANDARD_PAGE_SIZE,
+    "FrameExportHeader must fit a single page"
+);
+
+//===========================================================================
+// FrameExport
+//===========================================================================
+
+/**
+ * Framebuffer ring living in a named shared memory segment.
+ *
+ * The game draws straight into the slot returned by begin_frame(), so
+ * exporting a frame costs no copy at all; other processes map the segment
+ * and read frames with a FrameReader. Each slot has its own seqlock, so a
+ * reader that is too slow to finish a frame before the ring comes around
+ * notices it and simply retries with a newer frame. The writer never
+ * waits for readers.
+ */
+class FrameExport final {
+public:
+    DEFAULT_CTOR(FrameExport);
+    DELETE_COPY(FrameExport);
+    DELETE_MOVE(FrameExport);
+
+    ~FrameExport();
+
+    static constexpr u32 DEFAULT_SLOTS = 3;
+
+    auto start(
+        std::string_view name,
+        s32 width,
+        s32 height,
+        u32 slot_count = DEFAULT_SLOTS
+    ) -> bool;
+
+    void stop();
+
+    /**
+     * Returns the pixels the next frame should be drawn into; they keep the
+     * contents the slot had slot_count frames ago.
+     */
+    auto begin_frame() -> graphics::ARGB*;
+
+    /** Publishes the frame started by begin_frame(). */
+    void end_frame();
+
+    [[nodiscard]] auto is_running() const -> bool
+    {
+        return mapping_.data != nullptr;
+    }
+
+private:
+    auto header() -> FrameExportHeader&;
+
+    memory::SharedMapping mapping_{};
+    std::string name_{};
+    u64 next_frame_{1};
+    u32 slot_{0};
+};
+
+//===========================================================================
+// FrameReader
+//===========================================================================
+
+/** A frame inside the shared segment; valid until the ring comes around. */
+struct FrameView {
+    const graphics::ARGB* pixels;
+    s32 width;
+    s32 height;
+    u64 stride;
+    u64 frame_number;
+    u64 timestamp_ns;
+    u32 slot;
+    u64 sequence;
+};
+
+/**
+ * Read side of a FrameExport, for use in other processes.
+ */
+class FrameReader final {
+public:
+    DEFAULT_CTOR(FrameReader);
+    DELETE_COPY(FrameReader);
+    DELETE_MOVE(FrameReader);
+
+    ~FrameReader();
+
+    /** Maps the segment; fails if it does not exist or is not an export. */
+    auto open(std::string_view name) -> bool;
+
+    void close();
+
+    /**
+     * Points `view` at the newest frame if it is newer than `after`. The
+     * pixels may be used in place, as long as validate() afterwards
+     * confirms that the writer did not reuse the slot meanwhile.
+     */
+    auto acquire(u64 after, FrameView& view) const -> bool;
+
+    [[nodiscard]] auto validate(const FrameView& view) const -> bool;
+
+    /**
+     * Copies the newest frame newer than `after` into `pixels` (tightly
+     * packed rows). Returns false if there was no new frame or it was
+     * overwritten while being copied.
+     */
+    auto read(u64 after, std::span<graphics::ARGB> pixels, FrameView& view)
+        const -> bool;
+
+    [[nodiscard]] auto header() const -> const FrameExportHeader&;
+
+private:
+    memory::SharedMapping mapping_{};
+    std::string name_{};
+};
+
+} // namespace engine::capture
@@ -0,0 +1,136 @@
+#include "graphics.h"
+#include "simd.h"
+#include <algorithm>
+#include <cmath>
+
+namespace engine::graphics {
+
+void screen_buffer_allocate(
+    ScreenBuffer& screen_buffer,
+    s32 width,
+    s32 height,
+    memory::PagePolicy page_policy
+)
+{
+    u64 pixels_size = static_cast<u64>(width) * static_cast<u64>(height);
+
+    screen_buffer.memory =
+        memory::allocate_pages(pixels_size * sizeof(ARGB), page_policy);
+    screen_buffer.pixels = static_cast<ARGB*>(screen_buffer.memory.data);
+    screen_buffer.pixels_size = pixels_size;
+    screen_buffer.width = width;
+    screen_buffer.height = height;
+    screen_buffer.scanlines = static_cast<u32>(height);
+}
+
+void screen_buffer_release(ScreenBuffer& screen_buffer)
+{
+    memory::release_pages(screen_buffer.memory);
+    screen_buffer = {};
+}
+
+void screen_buffer_fill(ScreenBuffer& screen_buffer, ARGB color)
+{
+    ARGB* pixels = screen_buffer.pixels;
+    u64 i = 0;
+
+    // pixels are cache line aligned, so the whole buffer can be filled with
+    // aligned full cache line stores
+#if defined(ENGINE_SIMD_AVX2)
+    const __m256i value = _mm256_set1_epi32(static_cast<s32>(color.value));
+    for (; i + 16 <= screen_buffer.pixels_size; i += 16) {
+        auto* target = reinterpret_cast<__m256i*>(pixels + i);
+        _mm256_store_si256(target, value);
+        _mm256_store_si256(target + 1, value);
+    }
+#elif defined(ENGINE_SIMD_SSE2)
+    const __m128i value = _mm_set1_epi32(static_cast<s32>(color.value));
+    for (; i + 16 <= screen_buffer.pixels_size; i += 16) {
+        auto* target = reinterpret_cast<__m128i*>(pixels + i);
+        _mm_store_si128(target, value);
+        _mm_store_si128(target + 1, value);
+        _mm_store_si128(target + 2, value);
+        _mm_store_si128(target + 3, value);
+    }
+#endif
+
+    for (; i < screen_buffer.pixels_size; ++i) {
+        pixels[i] = color;
+    }
+}
+
+void screen_buffer_draw_line(
+    ScreenBuffer& screen_buffer,
+    f32 x0,
+    f32 y0,
+    f32 x1,
+    f32 y1,
+    ARGB color
+)
+{
+    if (screen_buffer.width <= 0 || screen_buffer.height <= 0) {
+        return;
+    }
+
+    // Liang-Barsky clipping against the pixel centers of the buffer
+    f32 max_x = static_cast<f32>(screen_buffer.width - 1);
+    f32 max_y = static_cast<f32>(screen_buffer.height - 1);
+    f32 dx = x1 - x0;
+    f32 dy = y1 - y0;
+    f32 p[4] = {-dx, dx, -dy, dy};
+    f32 q[4] = {x0, max_x - x0, y0, max_y - y0};
+
+    f32 t0 = 0.0f;
+    f32 t1 = 1.0f;
+    for (u32 i = 0; i < 4; ++i) {
+        if (p[i] == 0.0f) {
+            if (q[i] < 0.0f) {
+                return;
+            }
+            continue;
+        }
+        f32 t = q[i] / p[i];
+        if (p[i] < 0.0f) {
+            t0 = std::max(t0, t);
+        } else {
+            t1 = std::min(t1, t);
+        }
+        if (t0 > t1) {
+            return;
+        }
+    }
+
+    // rounding may still push an endpoint half a pixel out; clamp it back
+    auto to_pixel = [](f32 value, s32 max) {
+        return std::clamp(static_cast<s32>(std::lround(value)), 0, max);
+    };
+    s32 ax = to_pixel(x0 + t0 * dx, screen_buffer.width - 1);
+    s32 ay = to_pixel(y0 + t0 * dy, screen_buffer.height - 1);
+    s32 bx = to_pixel(x0 + t1 * dx, screen_buffer.width - 1);
+    s32 by = to_pixel(y0 + t1 * dy, screen_buffer.height - 1);
+
+    // Bresenham; walks a pixel pointer instead of recomputing indices
+    s32 delta_x = std::abs(bx - ax);
+    s32 delta_y = -std::abs(by - ay);
+    s32 step_x = ax < bx ? 1 : -1;
+    s32 step_y = ay < by ? screen_buffer.width : -screen_buffer.width;
+    s32 error = delta_x + delta_y;
+
+    ARGB* pixel = screen_buffer.pixels +
+                  static_cast<s64>(ay) * screen_buffer.width + ax;
+    for (s32 remaining = std::max(delta_x, -delta_y); remaining >= 0;
+         --remaining) {
+        *pixel = color;
+        s32 error2 = 2 * error;
+        if (error2 >= delta_y) {
+            error += delta_y;
+            pixel += step_x;
+        }
+        if (error2 <= delta_x) {
+            error += delta_x;
+            pixel += step_y;
+        }
+    }
+}
+
+} // namespace engine::graphics
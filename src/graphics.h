@@ -0,0 +1,76 @@
+#pragma once
+
+#include "core.h"
+#include "page_allocator.h"
+
+namespace engine::graphics {
+
+union ARGB {
+    u32 value;
+    u8 data[4];
+
+    // color components;
+    // the order is important since the value is stored in little-endian
+    // format: i.e. instead of RGB, it's stored as BGR; the alpha channel is
+    // currently unused
+    struct Colors {
+        u8 blue;
+        u8 green;
+        u8 red;
+        u8 alpha;
+    } colors;
+};
+
+static_assert(sizeof(ARGB) == sizeof(u32), "ARGB must be exactly 32 bits");
+
+/** Alignment guaranteed for ScreenBuffer::pixels. */
+constexpr u64 PIXEL_ALIGNMENT = 64;
+
+/**
+ * Platform independent 32-bit top-down pixel buffer. The platform layer is
+ * responsible for presenting the pixels (e.g. via BITMAPINFO on Win32).
+ */
+struct ScreenBuffer {
+    ARGB* pixels; // aligned to PIXEL_ALIGNMENT
+    u64 pixels_size;
+    s32 width;
+    s32 height;
+    u32 scanlines; // same as height
+    memory::PageAllocation memory;
+};
+
+constexpr auto argb_create(u8 red, u8 green, u8 blue) -> ARGB
+{
+    return ARGB{.colors = {blue, green, red, 0}};
+}
+
+/**
+ * Allocates zeroed pixel storage for the given dimensions straight from the
+ * OS. The pixels are page aligned and zeroed lazily on first touch.
+ */
+void screen_buffer_allocate(
+    ScreenBuffer& screen_buffer,
+    s32 width,
+    s32 height,
+    memory::PagePolicy page_policy = memory::PagePolicy::STANDARD_PAGES
+);
+
+void screen_buffer_release(ScreenBuffer& screen_buffer);
+
+void screen_buffer_fill(ScreenBuffer& screen_buffer, ARGB color);
+
+/**
+ * Draws a one pixel wide line between two points given in (sub)pixel
+ * coordinates. The line is clipped against the buffer once, so the
+ * rasterization loop itself does no bounds checks.
+ */
+void screen_buffer_draw_line(
+    ScreenBuffer& screen_buffer,
+    f32 x0,
+    f32 y0,
+    f32 x1,
+    f32 y1,
+    ARGB color
+);
+
+} // namespace engine::graphics
@@ -0,0 +1,97 @@
+#include "input.h"
+
+namespace engine::input {
+
+//===========================================================================
+// InputQueue
+//===========================================================================
+
+auto InputQueue::push(const InputEvent& event) -> bool
+{
+    if (!events_.try_push(event)) {
+        events_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+auto InputQueue::drain(u64 tick, time::Instant tick_end, InputState& state)
+    -> u32
+{
+    state.tick = tick;
+    state.pressed = 0;
+    state.released = 0;
+
+    u32 applied = 0;
+    InputEvent event{};
+    while (events_.try_peek(event) &&
+           event.timestamp.nanosecond_value() <= tick_end.nanosecond_value()) {
+        events_.try_pop(event);
+
+        u32 mask = 1u << event.button;
+        if (event.pressed) {
+            // key repeat of a held button is not a new press
+            state.pressed |= mask & ~state.held;
+            state.held |= mask;
+        } else {
+            state.released |= mask & state.held;
+            state.held &= ~mask;
+        }
+        ++applied;
+    }
+    return applied;
+}
+
+auto InputQueue::events_dropped() const -> u64
+{
+    return events_dropped_.load(std::memory_order_relaxed);
+}
+
+//===========================================================================
+// InputInjector
+//===========================================================================
+
+InputInjector::InputInjector(
+    std::span<const ScriptedInput> script,
+    u64 period
+) :
+    script_(script),
+    period_(period)
+{
+}
+
+void InputInjector::inject(
+    u64 tick,
+    time::Instant timestamp,
+    InputQueue& queue
+)
+{
+    if (!started_) {
+        start_tick_ = tick;
+        started_ = true;
+    }
+
+    while (true) {
+        if (next_ == script_.size()) {
+            if (period_ == 0 || tick - start_tick_ < period_) {
+                return;
+            }
+            start_tick_ += period_;
+            next_ = 0;
+        }
+
+        const ScriptedInput& input = script_[next_];
+        if (input.tick > tick - start_tick_) {
+            return;
+        }
+        queue.push({timestamp, input.button, input.pressed});
+        ++next_;
+    }
+}
+
+auto InputInjector::finished() const -> bool
+{
+    return period_ == 0 && next_ == script_.size();
+}
+
+} // namespace engine::input
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "core.h"
+#include "spsc_queue.h"
+#include "time.h"
+#include <atomic>
+#include <span>
+
+namespace engine::input {
+
+enum Button : u8 {
+    BUTTON_LEFT,
+    BUTTON_RIGHT,
+    BUTTON_THRUST,
+    BUTTON_FIRE,
+    BUTTON_REWIND,
+    BUTTON_COUNT,
+};
+
+struct InputEvent {
+    time::Instant timestamp;
+    Button button;
+    bool pressed;
+};
+
+//===========================================================================
+// InputState
+//===========================================================================
+
+/**
+ * Button state as seen by one simulation tick. Besides the held buttons it
+ * remembers the edges of the tick, so a tap that starts and ends between
+ * two ticks is still seen as a press.
+ */
+struct InputState {
+    /** Tick the state was last drained for. */
+    u64 tick;
+    u32 held;
+    u32 pressed;
+    u32 released;
+
+    [[nodiscard]] auto is_held(Button button) const -> bool
+    {
+        return (held & (1u << button)) != 0;
+    }
+
+    [[nodiscard]] auto was_pressed(Button button) const -> bool
+    {
+        return (pressed & (1u << button)) != 0;
+    }
+
+    [[nodiscard]] auto was_released(Button button) const -> bool
+    {
+        return (released & (1u << button)) != 0;
+    }
+
+    /** Held now or pressed at some point during the tick. */
+    [[nodiscard]] auto is_active(Button button) const -> bool
+    {
+        return is_held(button) || was_pressed(button);
+    }
+};
+
+//===========================================================================
+// InputQueue
+//===========================================================================
+
+/**
+ * Timestamped button events from the platform layer to the simulation.
+ *
+ * The platform side pushes events as they arrive, from whichever thread
+ * owns the window; the simulation drains them once per tick. An event
+ * belongs to the first tick that ends at or after its timestamp, so events
+ * arriving while a tick is being processed are left for the next one.
+ * Pushing never blocks: when the simulation falls behind, events are
+ * dropped and counted.
+ */
+class InputQueue final {
+public:
+    DEFAULT_CTOR(InputQueue);
+    DEFAULT_DTOR(InputQueue);
+    DELETE_COPY(InputQueue);
+    DELETE_MOVE(InputQueue);
+
+    static constexpr u32 CAPACITY = 256;
+
+    /** Producer side. Returns false when the event had to be dropped. */
+    auto push(const InputEvent& event) -> bool;
+
+    /**
+     * Consumer side. Applies every event with a timestamp up to `tick_end`
+     * to `state` and marks it as the state of `tick`. Returns the number of
+     * events applied.
+     */
+    auto drain(u64 tick, time::Instant tick_end, InputState& state) -> u32;
+
+    [[nodiscard]] auto events_dropped() const -> u64;
+
+private:
+    sync::SpscQueue<InputEvent, CAPACITY> events_{};
+    std::atomic<u64> events_dropped_{0};
+};
+
+//===========================================================================
+// InputInjector
+//===========================================================================
+
+struct ScriptedInput {
+    /** Tick, relative to the start of the script, the event belongs to. */
+    u64 tick;
+    Button button;
+    bool pressed;
+};
+
+/**
+ * Plays back a fixed input script through an InputQueue, standing in for
+ * the platform layer when there is no window or keyboard, e.g. headless
+ * runs and tests. The script must be sorted by tick; a non-zero period
+ * restarts it every `period` ticks.
+ */
+class InputInjector final {
+public:
+    DEFAULT_CTOR(InputInjector);
+    DEFAULT_DTOR(InputInjector);
+    DEFAULT_COPY(InputInjector);
+    DEFAULT_MOVE(InputInjector);
+
+    explicit InputInjector(
+        std::span<const ScriptedInput> script,
+        u64 period = 0
+    );
+
+    /**
+     * Pushes the events of `tick` with the given timestamp; it should not be
+     * later than the end of that tick.
+     */
+    void inject(u64 tick, time::Instant timestamp, InputQueue& queue);
+
+    [[nodiscard]] auto finished() const -> bool;
+
+private:
+    std::span<const ScriptedInput> script_{};
+    u64 period_{0};
+    u64 start_tick_{0};
+    u64 next_{0};
+    bool started_{false};
+};
+
+} // namespace engine::input
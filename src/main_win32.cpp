@@ -1,39 +1,157 @@
+#include "bullet_pool.h"
+#include "collision.h"
+#include "asset_archive.h"
+#include "asteroid_shapes.h"
+#include "audio_mixer.h"
 #include "core.h"
+#include "dirty_regions.h"
+#include "frame_capture.h"
+#include "frame_export.h"
+#include "graphics.h"
+#include "input.h"
+#include "mesh_batch.h"
+#include "metrics.h"
+#include "particle_system.h"
 #include "prng.h"
+#include "quality_governor.h"
+#include "shared_memory.h"
+#include "snapshot_ring.h"
+#include "starfield.h"
+#include "stroke_font.h"
+#include "tasks.h"
 #include "time.h"
+#include "timer_wheel.h"
+#include "upscaler.h"
+#include "vecmath.h"
+#include "world.h"
+#include <algorithm>
+#include <charconv>
 #include <cstring>
+#include <filesystem>
 #include <format>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 
-union ARGB {
-    u32 value;
-    u8 data[4];
-
-    // color components;
-    // the order is important since the value is stored in little-endian
-    // format: i.e. instead of RGB, it's stored as BGR; the alpha channel is
-    // currently unused
-    struct Colors {
-        u8 blue;
-        u8 green;
-        u8 red;
-        u8 alpha;
-    } colors;
-};
+#include <shellapi.h>
 
-struct ScreenBuffer {
-    BITMAPINFO bitmap_info;
-    ARGB* pixels;
-    u64 pixels_size;
-    s32 width;
-    s32 height;
-    u32 scanlines; // same as height
-};
+using engine::graphics::ARGB;
+using engine::graphics::argb_create;
+using engine::graphics::screen_buffer_fill;
+using engine::graphics::ScreenBuffer;
 
 static volatile bool g_run_game{true};
 static ScreenBuffer g_screen_buffer{};
+static BITMAPINFO g_bitmap_info{};
+static engine::capture::FrameCapture g_frame_capture{};
+// when running, the screen buffer pixels live in the export's shared ring
+static engine::capture::FrameExport g_frame_export{};
+
+/**
+ * The game can render into a smaller internal buffer which is then upscaled
+ * to the window resolution; this makes the render cost (mostly) independent
+ * of the window size. The world is as large as that internal resolution.
+ */
+struct RenderSettings {
+    // internal resolution is window resolution divided by this
+    s32 downscale;
+    engine::graphics::ScaleFilter filter;
+    // erase only what the previous frame drew instead of clearing it all
+    bool dirty_erase;
+    // paint the starfield at the quality levels that have layers; it
+    // repaints the whole target every frame, which bypasses dirty_erase
+    bool starfield;
+};
+
+/**
+ * What a quality level trades for speed. Lower levels may halve the
+ * internal resolution once more, in which case the world is drawn at half
+ * scale.
+ */
+struct QualityPreset {
+    u32 render_shift;
+    // upscale with the configured filter instead of nearest neighbour
+    bool smooth_upscale;
+    u32 particle_percent;
+    bool bullet_streaks;
+    // background layers when the starfield is enabled; without any the
+    // background is plain black
+    u32 star_layers;
+};
+
+static constexpr QualityPreset QUALITY_PRESETS[] = {
+    {1, false, 25, false, 0},
+    {1, true, 50, true, 1},
+    {0, true, 50, true, 2},
+    {0, true, 100, true, 3},
+};
+static constexpr auto QUALITY_LEVELS =
+    static_cast<u32>(std::size(QUALITY_PRESETS));
+
+static RenderSettings g_render_settings{
+    1,                         // downscale
+    engine::graphics::NEAREST, // filter
+    true,                      // dirty_erase
+    false,                     // starfield
+};
+static u32 g_quality_level{QUALITY_LEVELS - 1};
+// internal buffers indexed by render shift
+static ScreenBuffer g_render_buffers[2]{};
+static engine::graphics::Upscaler g_upscaler{};
+static engine::world::WorldBounds g_world_bounds{};
+
+static auto quality() -> const QualityPreset&
+{
+    return QUALITY_PRESETS[g_quality_level];
+}
+
+/**
+ * Buffer the game world is drawn into; either an internal low resolution
+ * buffer or the screen buffer itself.
+ */
+static auto render_target() -> ScreenBuffer&
+{
+    u32 shift = quality().render_shift;
+    if (g_render_settings.downscale == 1 && shift == 0) {
+        return g_screen_buffer;
+    }
+    return g_render_buffers[shift];
+}
+
+/**
+ * Drawing record of the given render target. A target has its own record
+ * for as long as it stays in use; the frame export hands out a different
+ * buffer every frame, so there are enough records for all of its slots.
+ */
+static auto dirty_regions(const ScreenBuffer& target)
+    -> engine::graphics::DirtyRegions&
+{
+    static engine::graphics::DirtyRegions
+        records[engine::capture::FrameExportHeader::MAX_SLOTS + 2];
+    static u32 next_record{0};
+
+    for (auto& record : records) {
+        if (record.tracks(target)) {
+            return record;
+        }
+    }
+    // a new buffer; erase() clears it completely the first time
+    return records[next_record++ % std::size(records)];
+}
+
+/** Size of a world unit in render target pixels. */
+static auto render_scale() -> f32
+{
+    return 1.0f / static_cast<f32>(1u << quality().render_shift);
+}
 
 static auto argb_create_random() -> ARGB
 {
@@ -44,203 +162,1288 @@ static auto argb_create_random() -> ARGB
     return argb;
 }
 
-static auto argb_create(u8 red, u8 green, u8 blue) -> ARGB
+static void screen_buffer_init(
+    ScreenBuffer& screen_buffer,
+    BITMAPINFO& bitmap_info,
+    s32 width,
+    s32 height
+)
+{
+    // setup bitmap info
+    bitmap_info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bitmap_info.bmiHeader.biWidth = width;    // width
+    bitmap_info.bmiHeader.biHeight = -height; // top-down bitmap
+    bitmap_info.bmiHeader.biPlanes = 1;       // must be 1
+    bitmap_info.bmiHeader.biBitCount = 32;    // 32-bit color
+    bitmap_info.bmiHeader.biCompression = BI_RGB; // BI_BITFIELDS
+    bitmap_info.bmiHeader.biSizeImage = 0; // 0 when uncompressed
+
+    // allocate pixel buffer; large buffers benefit from huge pages since a
+    // full screen clear would otherwise walk through thousands of 4K pages
+    engine::graphics::screen_buffer_allocate(
+        screen_buffer,
+        width,
+        height,
+        engine::memory::PagePolicy::EXPLICIT_HUGE_PAGES
+    );
+}
+
+static void
+screen_buffer_draw_pixel(ScreenBuffer& screen_buffer, s32 x, s32 y, ARGB color)
+{
+    // FIXME: change to assert
+    if (x < 0 || x >= screen_buffer.width || y < 0 ||
+        y >= screen_buffer.height) {
+        return;
+    }
+
+    auto index = y * screen_buffer.width + x;
+    screen_buffer.pixels[index] = color;
+}
+
+static void screen_buffer_fill_random(ScreenBuffer& screen_buffer)
+{
+    ARGB argb = argb_create_random();
+    screen_buffer_fill(screen_buffer, argb);
+}
+
+static void screen_buffer_blit(
+    HDC device_context,
+    ScreenBuffer& screen_buffer,
+    const BITMAPINFO& bitmap_info
+)
+{
+    // prepare the bitmap
+    HDC memory_dc = CreateCompatibleDC(device_context);
+    HBITMAP bitmap = CreateCompatibleBitmap(
+        device_context,
+        screen_buffer.width,
+        screen_buffer.height
+    );
+    SelectObject(memory_dc, bitmap);
+
+    // transfer the pixel data to the bitmap
+    SetDIBits(
+        memory_dc,                  // target; device context
+        bitmap,                     // target; i.e. bitmap to be altered
+        0,                          // start scan line
+        screen_buffer.scanlines,    // number of scan lines
+        screen_buffer.pixels,       // source
+        &bitmap_info,               // bitmap info
+        DIB_RGB_COLORS              // literal RGB values
+    );
+
+    MUSTE(BitBlt(
+        device_context,       // dest DC
+        0,                    // dest upper-left X
+        0,                    // dest upper-left Y
+        screen_buffer.width,  // dest and src rect width
+        screen_buffer.height, // dest and src rect height
+        memory_dc,            // src
+        0,                    // src upper-left X
+        0,                    // src upper-left Y
+        SRCCOPY
+    ));
+
+    // clean up
+    DeleteObject(bitmap);
+    DeleteDC(memory_dc);
+}
+
+//============================================================================
+// Game
+//============================================================================
+
+// classic asteroids world: whatever leaves one edge re-enters from the
+// opposite one; switch off to keep everything inside the screen instead
+static constexpr bool WORLD_WRAPS = true;
+
+using WorldBoundary = std::conditional_t<
+    WORLD_WRAPS,
+    engine::particles::WrapBoundary,
+    engine::particles::BounceBoundary>;
+
+using AmbientParticles = engine::particles::ParticleSystem<
+    100,
+    WorldBoundary,
+    engine::particles::OpaqueBlend,
+    engine::particles::SoaLayout>;
+
+static AmbientParticles g_particles{};
+
+/**
+ * Spawns or drops particles until the count matches the budget of the
+ * current quality level.
+ */
+static void particles_fit_budget(engine::world::WorldBounds bounds)
+{
+    s32 max_x = bounds.width - 1;
+    s32 max_y = bounds.height - 1;
+
+    u32 budget = AmbientParticles::CAPACITY * quality().particle_percent / 100;
+    g_particles.truncate(budget);
+    for (u32 i = g_particles.count(); i < budget; ++i) {
+        g_particles.spawn({
+            engine::prng::random<s32>(max_x, 0), // x
+            engine::prng::random<s32>(max_y, 0), // y
+            engine::prng::random<s32>(2, -2),    // velocity_x
+            engine::prng::random<s32>(2, -2),    // velocity_y
+            argb_create_random(),                // color
+        });
+    }
+}
+
+static void particles_init(engine::world::WorldBounds bounds)
+{
+    g_particles.clear();
+    particles_fit_budget(bounds);
+}
+
+static void particles_draw(
+    ScreenBuffer& screen_buffer,
+    engine::graphics::DirtyRegions& dirty
+)
+{
+    g_particles.draw(screen_buffer, quality().render_shift, &dirty);
+}
+
+static void particles_update(engine::world::WorldBounds bounds)
+{
+    g_particles.update(bounds.width, bounds.height);
+}
+
+//============================================================================
+// Audio
+//============================================================================
+//
+// Sound effects are synthesized once at startup. g_audio_mixer mixes them
+// on its own thread; the game only queues commands and never waits for it.
+//
+
+struct Sounds {
+    std::vector<s16> fire;
+    std::vector<s16> rock_explosion;
+    std::vector<s16> ship_explosion;
+};
+
+static engine::audio::AudioSink g_audio_sink{};
+// declared after the sink so that it stops before the sink goes away
+static engine::audio::AudioMixer g_audio_mixer{};
+static Sounds g_sounds{};
+
+static auto sound_length(f32 seconds) -> u64
+{
+    return static_cast<u64>(
+        seconds * static_cast<f32>(engine::audio::AudioMixer::SAMPLE_RATE)
+    );
+}
+
+/**
+ * Decaying noise; `smoothing` close to 1 filters out the high end for a
+ * deeper rumble.
+ */
+static auto sound_explosion(f32 seconds, f32 smoothing) -> std::vector<s16>
+{
+    // fixed seed: the game's generator is part of the simulation state
+    std::minstd_rand noise{0x5eed};
+    std::vector<s16> samples(sound_length(seconds));
+    auto length = static_cast<f32>(samples.size());
+    f32 filtered = 0.0f;
+    for (u64 i = 0; i < samples.size(); ++i) {
+        auto white = static_cast<f32>(noise() % 65536) - 32768.0f;
+        filtered += (white - filtered) * (1.0f - smoothing);
+        f32 decay = 1.0f - static_cast<f32>(i) / length;
+        samples[i] = static_cast<s16>(filtered * decay * decay * 0.8f);
+    }
+    return samples;
+}
+
+static void sounds_init()
+{
+    constexpr auto RATE =
+        static_cast<f32>(engine::audio::AudioMixer::SAMPLE_RATE);
+
+    // square wave sweeping down from 1.6 kHz
+    g_sounds.fire.resize(sound_length(0.12f));
+    f32 phase = 0.0f;
+    for (u64 i = 0; i < g_sounds.fire.size(); ++i) {
+        f32 t = static_cast<f32>(i) / static_cast<f32>(g_sounds.fire.size());
+        phase += (1600.0f - 1200.0f * t) / RATE;
+        phase -= static_cast<f32>(static_cast<s32>(phase));
+        f32 level = (1.0f - t) * 6000.0f;
+        g_sounds.fire[i] = static_cast<s16>(phase < 0.5f ? level : -level);
+    }
+
+    g_sounds.rock_explosion = sound_explosion(0.4f, 0.6f);
+    g_sounds.ship_explosion = sound_explosion(1.2f, 0.9f);
+}
+
+/**
+ * Plays a sound panned by the horizontal position it comes from; does
+ * nothing when audio is off.
+ */
+static void sound_play(
+    const std::vector<s16>& samples,
+    f32 x,
+    engine::world::WorldBounds bounds,
+    f32 volume = 1.0f
+)
+{
+    if (!g_audio_mixer.is_running()) {
+        return;
+    }
+    // never fully to one side
+    f32 pan = (x / static_cast<f32>(bounds.width) * 2.0f - 1.0f) * 0.8f;
+    g_audio_mixer.play({samples}, volume, pan);
+}
+
+//============================================================================
+// Ship and asteroids
+//============================================================================
+
+using engine::math::vec2;
+
+struct Ship {
+    vec2 position;
+    vec2 velocity;
+    f32 rotation;
+    bool alive;
+    // set for a while after a respawn; asteroids pass through the ship
+    bool invulnerable;
+};
+
+struct Asteroid {
+    vec2 position;
+    vec2 velocity;
+    f32 rotation;
+    f32 spin;
+    f32 scale;
+    engine::graphics::MeshId mesh;
+};
+
+struct Meshes {
+    engine::graphics::MeshId ship;
+};
+
+static constexpr u32 MAX_ASTEROIDS = 256;
+static constexpr u32 INITIAL_ASTEROIDS = 8;
+
+// one entry per size class, from the biggest rock to the smallest
+static constexpr engine::graphics::AsteroidShapeClass ASTEROID_SHAPES[] = {
+    {14, 0.40f},
+    {11, 0.35f},
+    {8, 0.30f},
+};
+static constexpr u32 ASTEROID_VARIANTS = 16;
+static constexpr u64 ASTEROID_SHAPE_SEED = 0xa57e501d;
+
+// optional content packed by tools/asset_packer; built-in data fills in
+// for whatever it does not contain
+static engine::assets::AssetArchive g_assets{};
+static engine::graphics::MeshLibrary g_mesh_library{};
+static engine::graphics::MeshBatch g_mesh_batch{};
+static Meshes g_meshes{};
+static engine::graphics::AsteroidShapes g_asteroid_shapes{};
+static Ship g_ship{};
+static Asteroid g_asteroids[MAX_ASTEROIDS];
+static u32 g_asteroid_count{0};
+
+static auto world_bounds() -> engine::world::WorldBounds
+{
+    return g_world_bounds;
+}
+
+/** The outline `name` from the asset archive; empty if there is none. */
+static auto mesh_asset(std::string_view name) -> std::span<const vec2>
+{
+    engine::assets::Asset asset{};
+    if (g_assets.find(name, asset) &&
+        asset.type == engine::assets::ASSET_MESH) {
+        return asset.as<vec2>();
+    }
+    return {};
+}
+
+/** Adds the outline `name` from the asset archive or else the fallback. */
+static auto mesh_add(std::string_view name, std::span<const vec2> fallback)
+    -> engine::graphics::MeshId
+{
+    auto outline = mesh_asset(name);
+    return g_mesh_library.add(outline.empty() ? fallback : outline);
+}
+
+static void meshes_init()
+{
+    // nose points along +x, i.e. at rotation 0
+    constexpr vec2 ship[] = {{12, 0}, {-8, -7}, {-4, 0}, {-8, 7}};
+
+    g_meshes.ship = mesh_add("meshes/ship", ship);
+
+    // a unit sized outline in the archive replaces one generated variant,
+    // e.g. meshes/rock/0/3 is variant 3 of the biggest rocks
+    std::vector<std::span<const vec2>> rocks(
+        std::size(ASTEROID_SHAPES) * ASTEROID_VARIANTS
+    );
+    for (u32 size_class = 0; size_class < std::size(ASTEROID_SHAPES);
+         ++size_class) {
+        for (u32 variant = 0; variant < ASTEROID_VARIANTS; ++variant) {
+            rocks[size_class * ASTEROID_VARIANTS + variant] = mesh_asset(
+                std::format("meshes/rock/{}/{}", size_class, variant)
+            );
+        }
+    }
+
+    g_asteroid_shapes.build(
+        g_mesh_library,
+        ASTEROID_SHAPE_SEED,
+        ASTEROID_SHAPES,
+        ASTEROID_VARIANTS,
+        rocks
+    );
+}
+
+static auto random_f32(s32 max, s32 min) -> f32
+{
+    return static_cast<f32>(engine::prng::random<s32>(max, min));
+}
+
+static void asteroids_spawn(u32 count, engine::world::WorldBounds bounds)
+{
+    constexpr f32 sizes[] = {40.0f, 20.0f, 10.0f};
+    static_assert(std::size(sizes) == std::size(ASTEROID_SHAPES));
+
+    for (u32 i = 0; i < count && g_asteroid_count < MAX_ASTEROIDS; ++i) {
+        vec2 position{
+            random_f32(bounds.width - 1, 0),
+            random_f32(bounds.height - 1, 0),
+        };
+        vec2 velocity{
+            random_f32(20, -20) / 10.0f,
+            random_f32(20, -20) / 10.0f,
+        };
+        f32 spin = random_f32(10, -10) / 200.0f;
+        u32 size_class = engine::prng::random<u32>(2, 0);
+        f32 scale = sizes[size_class];
+        auto mesh = g_asteroid_shapes.mesh(
+            size_class,
+            engine::prng::random<u32>(ASTEROID_VARIANTS - 1, 0)
+        );
+
+        g_asteroids[g_asteroid_count++] = {
+            position, // position
+            velocity, // velocity
+            0.0f,     // rotation
+            spin,     // spin
+            scale,    // scale
+            mesh,     // mesh
+        };
+    }
+}
+
+static void asteroids_init(engine::world::WorldBounds bounds)
+{
+    vec2 center{
+        static_cast<f32>(bounds.width) / 2.0f,
+        static_cast<f32>(bounds.height) / 2.0f,
+    };
+    g_ship = {center, {0.0f, 0.0f}, 0.0f, true, false};
+
+    g_asteroid_count = 0;
+    asteroids_spawn(INITIAL_ASTEROIDS, bounds);
+}
+
+static void asteroids_update(engine::world::WorldBounds bounds)
+{
+    auto width = static_cast<f32>(bounds.width);
+    auto height = static_cast<f32>(bounds.height);
+
+    for (u32 i = 0; i < g_asteroid_count; ++i) {
+        Asteroid& asteroid = g_asteroids[i];
+        asteroid.position += asteroid.velocity;
+        asteroid.rotation += asteroid.spin;
+
+        if constexpr (WORLD_WRAPS) {
+            asteroid.position.x =
+                engine::world::wrap_near(asteroid.position.x, width);
+            asteroid.position.y =
+                engine::world::wrap_near(asteroid.position.y, height);
+        } else {
+            if (asteroid.position.x < 0.0f || asteroid.position.x >= width) {
+                asteroid.velocity.x = -asteroid.velocity.x;
+            }
+            if (asteroid.position.y < 0.0f || asteroid.position.y >= height) {
+                asteroid.velocity.y = -asteroid.velocity.y;
+            }
+        }
+    }
+}
+
+static void objects_draw(
+    ScreenBuffer& screen_buffer,
+    engine::graphics::DirtyRegions& dirty
+)
+{
+    static const ARGB white = argb_create(0xff, 0xff, 0xff);
+    static const ARGB gray = argb_create(0xa0, 0xa0, 0xa0);
+
+    // instances are placed in render target pixels
+    engine::world::WorldBounds bounds{
+        screen_buffer.width,
+        screen_buffer.height,
+    };
+    f32 scale = render_scale();
+
+    g_mesh_batch.clear();
+    if (g_ship.alive) {
+        g_mesh_batch.add(
+            g_mesh_library,
+            {
+                g_meshes.ship,
+                g_ship.position * scale,
+                g_ship.rotation,
+                scale,
+                white,
+            },
+            bounds
+        );
+    }
+    for (u32 i = 0; i < g_asteroid_count; ++i) {
+        const Asteroid& asteroid = g_asteroids[i];
+        g_mesh_batch.add(
+            g_mesh_library,
+            {
+                asteroid.mesh,
+                asteroid.position * scale,
+                asteroid.rotation,
+                asteroid.scale * scale,
+                gray,
+            },
+            bounds
+        );
+    }
+
+    g_mesh_batch.transform();
+    g_mesh_batch.draw(screen_buffer);
+    g_mesh_batch.mark(dirty);
+}
+
+//============================================================================
+// Timers
+//============================================================================
+//
+// Cooldowns and other plain delays are callbacks in g_timers, which is
+// advanced by one tick per game_update.
+//
+
+static constexpr u32 TICKS_PER_SECOND = 30;
+
+static engine::timers::TimerWheel g_timers{
+    engine::time::Duration::of(1000000000 / TICKS_PER_SECOND)
+};
+
+//============================================================================
+// Input
+//============================================================================
+//
+// The platform layer pushes timestamped button events into g_input_queue;
+// game_update drains them into g_input once per tick.
+//
+
+using engine::input::Button;
+
+static engine::input::InputQueue g_input_queue{};
+static engine::input::InputState g_input{};
+static u64 g_tick{0};
+// advances by the tick delta; the simulation never reads the wall clock
+static u64 g_game_time_ns{0};
+
+// the ship flies itself until the first button event arrives
+static bool g_player_control{false};
+
+//============================================================================
+// Bullets
+//============================================================================
+
+static constexpr u32 MAX_BULLETS = 64;
+static constexpr f32 BULLET_SPEED = 6.0f;
+static constexpr f32 ATTRACT_SPIN = 0.03f;
+static constexpr f32 SHIP_TURN_SPEED = 0.1f;
+static constexpr f32 SHIP_THRUST = 0.2f;
+static constexpr f32 SHIP_DRAG = 0.99f;
+
+static const engine::time::Duration BULLET_LIFETIME =
+    engine::time::Duration::of(1, engine::time::TimeUnit::SECONDS);
+static const engine::time::Duration FIRE_COOLDOWN =
+    engine::time::Duration::of(250, engine::time::TimeUnit::MILLISECONDS);
+
+static engine::bullets::BulletPool<MAX_BULLETS> g_bullets{};
+static bool g_gun_ready{true};
+
+static void gun_reload([[maybe_unused]] void* context)
+{
+    g_gun_ready = true;
+}
+
+/**
+ * Steers the ship from the input of this tick. Until there is player input
+ * the ship runs in attract mode instead: it turns slowly and fires whenever
+ * the gun is ready.
+ */
+static void ship_update(
+    engine::world::WorldBounds bounds,
+    engine::time::Instant now
+)
+{
+    if (!g_ship.alive) {
+        return;
+    }
+
+    bool fire = true;
+    if (g_player_control) {
+        if (g_input.is_active(engine::input::BUTTON_LEFT)) {
+            g_ship.rotation -= SHIP_TURN_SPEED;
+        }
+        if (g_input.is_active(engine::input::BUTTON_RIGHT)) {
+            g_ship.rotation += SHIP_TURN_SPEED;
+        }
+        if (g_input.is_active(engine::input::BUTTON_THRUST)) {
+            g_ship.velocity +=
+                engine::math::from_angle(g_ship.rotation) * SHIP_THRUST;
+        }
+        fire = g_input.is_active(engine::input::BUTTON_FIRE);
+    } else {
+        g_ship.rotation += ATTRACT_SPIN;
+    }
+
+    g_ship.velocity *= SHIP_DRAG;
+    g_ship.position += g_ship.velocity;
+    g_ship.position.x = engine::world::wrap_near(
+        g_ship.position.x,
+        static_cast<f32>(bounds.width)
+    );
+    g_ship.position.y = engine::world::wrap_near(
+        g_ship.position.y,
+        static_cast<f32>(bounds.height)
+    );
+
+    if (fire && g_gun_ready) {
+        vec2 direction = engine::math::from_angle(g_ship.rotation);
+        g_bullets.spawn(
+            g_ship.position + direction * 12.0f,
+            g_ship.velocity + direction * BULLET_SPEED,
+            now
+        );
+        g_gun_ready = false;
+        g_timers.schedule(FIRE_COOLDOWN, gun_reload, nullptr);
+        sound_play(g_sounds.fire, g_ship.position.x, bounds, 0.5f);
+    }
+}
+
+static void bullets_update(
+    engine::world::WorldBounds bounds,
+    engine::time::Instant now
+)
+{
+    g_bullets.expire(now, BULLET_LIFETIME);
+
+    auto width = static_cast<f32>(bounds.width);
+    auto height = static_cast<f32>(bounds.height);
+    g_bullets.for_each([&](engine::bullets::Bullet& bullet) {
+        bullet.position += bullet.velocity;
+        bullet.position.x = engine::world::wrap_near(bullet.position.x, width);
+        bullet.position.y =
+            engine::world::wrap_near(bullet.position.y, height);
+    });
+}
+
+static void bullets_draw(
+    ScreenBuffer& screen_buffer,
+    engine::graphics::DirtyRegions& dirty
+)
+{
+    static const ARGB yellow = argb_create(0xff, 0xe0, 0x40);
+
+    f32 scale = render_scale();
+    if (!quality().bullet_streaks) {
+        g_bullets.for_each([&](const engine::bullets::Bullet& bullet) {
+            vec2 head = bullet.position * scale;
+            auto x = static_cast<s32>(head.x);
+            auto y = static_cast<s32>(head.y);
+            screen_buffer_draw_pixel(screen_buffer, x, y, yellow);
+            dirty.mark({x, y, x + 1, y + 1});
+        });
+        return;
+    }
+
+    // a short streak behind the bullet; line clipping cuts it at the edges
+    g_bullets.for_each([&](const engine::bullets::Bullet& bullet) {
+        vec2 head = bullet.position * scale;
+        vec2 tail = (bullet.position - bullet.velocity) * scale;
+        engine::graphics::screen_buffer_draw_line(
+            screen_buffer,
+            head.x,
+            head.y,
+            tail.x,
+            tail.y,
+            yellow
+        );
+        dirty.mark({
+            static_cast<s32>(std::min(head.x, tail.x)) - 1, // left
+            static_cast<s32>(std::min(head.y, tail.y)) - 1, // top
+            static_cast<s32>(std::max(head.x, tail.x)) + 2, // right
+            static_cast<s32>(std::max(head.y, tail.y)) + 2, // bottom
+        });
+    });
+}
+
+//============================================================================
+// HUD
+//============================================================================
+
+struct Hud {
+    engine::graphics::StrokeFont font;
+    // laid out again only when the text changes
+    engine::graphics::TextLayout score_text;
+    engine::graphics::TextLayout lives_text;
+    engine::graphics::TextLayout fps_text;
+    u32 score;
+    u32 lives;
+};
+
+static Hud g_hud{};
+
+static void hud_init()
+{
+    auto white = argb_create(0xff, 0xff, 0xff);
+    g_hud.font = engine::graphics::StrokeFont::create(white, 14);
+    g_hud.score = 0;
+    g_hud.lives = 3;
+}
+
+/**
+ * Formats "<label><value>" into the given buffer without allocating.
+ */
+static auto
+hud_format(std::span<char> buffer, std::string_view label, u64 value)
+    -> std::string_view
+{
+    char* out = std::copy(label.begin(), label.end(), buffer.data());
+    auto result = std::to_chars(out, buffer.data() + buffer.size(), value);
+    return {buffer.data(), result.ptr};
+}
+
+static void hud_text(
+    ScreenBuffer& screen_buffer,
+    engine::graphics::DirtyRegions* dirty,
+    const engine::graphics::TextLayout& text,
+    s32 x,
+    s32 y
+)
+{
+    text.draw(screen_buffer, x, y);
+    if (dirty != nullptr) {
+        dirty->mark({x, y, x + text.width(), y + text.height()});
+    }
+}
+
+/**
+ * Draws the HUD at full resolution; the text is marked in `dirty` if the
+ * screen buffer is also the render target.
+ */
+static void hud_draw(
+    engine::time::Duration delta,
+    ScreenBuffer& screen_buffer,
+    engine::graphics::DirtyRegions* dirty
+)
+{
+    const auto& font = g_hud.font;
+    const s32 margin = 8;
+    char buffer[32];
+
+    g_hud.score_text.set_text(
+        font,
+        hud_format(buffer, "SCORE:", g_hud.score)
+    );
+    hud_text(screen_buffer, dirty, g_hud.score_text, margin, margin);
+
+    g_hud.lives_text.set_text(
+        font,
+        hud_format(buffer, "LIVES:", g_hud.lives)
+    );
+    s32 lives_y = margin + font.line_height();
+    hud_text(screen_buffer, dirty, g_hud.lives_text, margin, lives_y);
+
+    u64 delta_ns = delta.nanosecond_value();
+    u64 fps = delta_ns > 0 ? 1000000000 / delta_ns : 0;
+    g_hud.fps_text.set_text(font, hud_format(buffer, "FPS:", fps));
+    s32 fps_x = screen_buffer.width - g_hud.fps_text.width() - margin;
+    hud_text(screen_buffer, dirty, g_hud.fps_text, fps_x, margin);
+}
+
+//============================================================================
+// Starfield
+//============================================================================
+//
+// The background scrolls against the ship's movement plus a slow drift;
+// nearer layers scroll faster. It is off unless `--starfield on` is given:
+// since it moves every tick, it costs a full pass over the render target
+// per frame where the black background only erases what was drawn.
+//
+
+static constexpr engine::graphics::StarLayerConfig STAR_LAYERS[] = {
+    {512, 512, 400, 0x70, 1, 0.1f, true},
+    {512, 512, 120, 0xb0, 1, 0.3f, false},
+    {512, 512, 30, 0xff, 2, 0.6f, false},
+};
+static constexpr vec2 STAR_DRIFT{0.5f, 0.1f};
+
+static engine::graphics::Starfield g_starfield{};
+static vec2 g_star_scroll{};
+
+static void starfield_update()
+{
+    g_star_scroll += g_ship.velocity + STAR_DRIFT;
+}
+
+/**
+ * Paints the background over the whole target; returns false if the
+ * starfield is off or the current quality level has no layers.
+ */
+static auto starfield_draw(ScreenBuffer& screen_buffer) -> bool
+{
+    u32 layers = quality().star_layers;
+    if (!g_render_settings.starfield || layers == 0) {
+        return false;
+    }
+    g_starfield.draw(screen_buffer, g_star_scroll * render_scale(), layers);
+    return true;
+}
+
+//============================================================================
+// Scripts
+//============================================================================
+//
+// Timed game sequences are coroutines run by g_scheduler; a waiting script
+// costs nothing until it is due.
+//
+
+static engine::tasks::Scheduler g_scheduler{};
+
+static constexpr u64 INVULNERABLE_TICKS = 60;
+
+static const engine::time::Duration RESPAWN_DELAY =
+    engine::time::Duration::of(1, engine::time::TimeUnit::SECONDS);
+static const engine::time::Duration WAVE_DELAY =
+    engine::time::Duration::of(2, engine::time::TimeUnit::SECONDS);
+
+static bool g_wave_pending{false};
+static u32 g_wave{0};
+
+static auto ship_invulnerable_script() -> engine::tasks::Task
+{
+    co_await g_scheduler.sleep_ticks(INVULNERABLE_TICKS);
+    g_ship.invulnerable = false;
+}
+
+/**
+ * Brings the ship back after it was destroyed; the game starts over once
+ * all lives are gone.
+ */
+static auto ship_respawn_script(engine::world::WorldBounds bounds)
+    -> engine::tasks::Task
+{
+    g_ship.alive = false;
+    co_await g_scheduler.sleep(RESPAWN_DELAY);
+
+    if (g_hud.lives == 0) {
+        g_hud.score = 0;
+        g_hud.lives = 3;
+    }
+
+    vec2 center{
+        static_cast<f32>(bounds.width) / 2.0f,
+        static_cast<f32>(bounds.height) / 2.0f,
+    };
+    g_ship = {center, {0.0f, 0.0f}, 0.0f, true, true};
+    g_scheduler.spawn(ship_invulnerable_script());
+}
+
+/**
+ * Spawns the next wave a moment after the field was cleared; every wave
+ * has one more rock than the previous one.
+ */
+static auto next_wave_script(engine::world::WorldBounds bounds)
+    -> engine::tasks::Task
+{
+    g_wave_pending = true;
+    co_await g_scheduler.sleep(WAVE_DELAY);
+
+    ++g_wave;
+    asteroids_spawn(INITIAL_ASTEROIDS + g_wave, bounds);
+    g_wave_pending = false;
+}
+
+//============================================================================
+// Collisions
+//============================================================================
+
+using engine::collision::Collider;
+using engine::collision::CollisionPair;
+
+/**
+ * Per-tick collision state; world space hull vertices of all colliders and
+ * the candidate pairs fed to the narrow phase.
+ */
+struct Collisions {
+    // convex hulls of the meshes; hull ids equal mesh ids
+    engine::graphics::MeshLibrary hulls;
+    engine::collision::NarrowPhase narrow_phase;
+    std::vector<f32> xs;
+    std::vector<f32> ys;
+    std::vector<u32> first_vertex;
+    std::vector<Collider> colliders;
+    std::vector<CollisionPair> candidates;
+    std::vector<CollisionPair> hits;
+};
+
+static Collisions g_collisions{};
+
+/**
+ * Builds the collision hull for every mesh loaded so far; the rock outlines
+ * are concave and the narrow phase works on convex polygons.
+ */
+static void hulls_init()
 {
-    ARGB argb{};
-    argb.colors.red = red;
-    argb.colors.green = green;
-    argb.colors.blue = blue;
-    return argb;
+    for (u32 id = g_collisions.hulls.mesh_count();
+         id < g_mesh_library.mesh_count();
+         ++id) {
+        const auto& mesh = g_mesh_library.mesh(id);
+        std::vector<vec2> points;
+        for (u32 i = 0; i < mesh.vertex_count; ++i) {
+            u32 vertex = mesh.first_vertex + i;
+            points.push_back(
+                {g_mesh_library.xs()[vertex], g_mesh_library.ys()[vertex]}
+            );
+        }
+        g_collisions.hulls.add(engine::collision::convex_hull(points));
+    }
 }
 
-static void screen_buffer_init(HWND window, ScreenBuffer& screen_buffer)
+/**
+ * Adds the world space hull of an object; returns the collider index.
+ */
+static auto collider_add(
+    engine::graphics::MeshId mesh,
+    vec2 position,
+    f32 rotation,
+    f32 scale
+) -> u32
 {
-    // resolve window size
-    RECT rect{};
-    MUSTE(GetClientRect(window, &rect));
-    s32 width = rect.right - rect.left;
-    s32 height = rect.bottom - rect.top;
-
-    // configure screen buffer bounds
-    screen_buffer.width = width;
-    screen_buffer.height = height;
-    screen_buffer.scanlines = static_cast<u32>(height);
-
-    // setup bitmap info
-    screen_buffer.bitmap_info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-    screen_buffer.bitmap_info.bmiHeader.biWidth = width;    // width
-    screen_buffer.bitmap_info.bmiHeader.biHeight = -height; // top-down bitmap
-    screen_buffer.bitmap_info.bmiHeader.biPlanes = 1;       // must be 1
-    screen_buffer.bitmap_info.bmiHeader.biBitCount = 32;    // 32-bit color
-    screen_buffer.bitmap_info.bmiHeader.biCompression = BI_RGB; // BI_BITFIELDS
-    screen_buffer.bitmap_info.bmiHeader.biSizeImage = 0; // 0 when uncompressed
+    const auto& hull = g_collisions.hulls.mesh(mesh);
+    auto first = static_cast<u32>(g_collisions.xs.size());
+    g_collisions.xs.resize(first + hull.vertex_count);
+    g_collisions.ys.resize(first + hull.vertex_count);
+    engine::math::transform_points(
+        engine::math::mat2x3::from_transform(position, rotation, scale),
+        g_collisions.hulls.xs() + hull.first_vertex,
+        g_collisions.hulls.ys() + hull.first_vertex,
+        g_collisions.xs.data() + first,
+        g_collisions.ys.data() + first,
+        hull.vertex_count
+    );
 
-    // allocate pixel buffer
-    u64 pixel_size = static_cast<u64>(width * height);
-    screen_buffer.pixels_size = pixel_size;
-    screen_buffer.pixels = new ARGB[pixel_size];
-    ZeroMemory(screen_buffer.pixels, width * height * sizeof(ARGB));
+    // vertex pointers are resolved once all hulls are in place
+    g_collisions.first_vertex.push_back(first);
+    g_collisions.colliders.push_back(
+        {position, hull.radius * scale, {nullptr, nullptr, hull.vertex_count}}
+    );
+    return static_cast<u32>(g_collisions.colliders.size() - 1);
 }
 
-static void screen_buffer_release(ScreenBuffer& screen_buffer)
+static auto asteroid_points(const Asteroid& asteroid) -> u32
 {
-    delete[] screen_buffer.pixels;
-    ZeroMemory(&screen_buffer, sizeof(ScreenBuffer));
+    // the smaller the rock, the more it is worth
+    return asteroid.scale >= 40.0f ? 20 : asteroid.scale >= 20.0f ? 50 : 100;
 }
 
-static void
-screen_buffer_draw_pixel(ScreenBuffer& screen_buffer, s32 x, s32 y, ARGB color)
+/**
+ * Ship against asteroids; asteroids that hit the ship are destroyed and the
+ * ship is lost. Bullets are points, so their bounding circle test against
+ * the rocks is exact enough.
+ */
+static void collisions_update(engine::world::WorldBounds bounds)
 {
-    // FIXME: change to assert
-    if (x < 0 || x >= screen_buffer.width || y < 0 ||
-        y >= screen_buffer.height) {
-        return;
+    auto& c = g_collisions;
+    c.xs.clear();
+    c.ys.clear();
+    c.first_vertex.clear();
+    c.colliders.clear();
+    c.candidates.clear();
+    c.hits.clear();
+
+    // a dead or invulnerable ship does not collide; its collider is still
+    // added so that asteroid colliders always start at index 1
+    bool ship_collides = g_ship.alive && !g_ship.invulnerable;
+    u32 ship = collider_add(
+        g_meshes.ship,
+        g_ship.position,
+        g_ship.rotation,
+        1.0f
+    );
+    for (u32 i = 0; i < g_asteroid_count; ++i) {
+        const Asteroid& asteroid = g_asteroids[i];
+        u32 collider = collider_add(
+            asteroid.mesh,
+            asteroid.position,
+            asteroid.rotation,
+            asteroid.scale
+        );
+        if (ship_collides) {
+            c.candidates.push_back({ship, collider});
+        }
     }
 
-    auto index = y * screen_buffer.width + x;
-    screen_buffer.pixels[index] = color;
+    for (u64 i = 0; i < c.colliders.size(); ++i) {
+        auto& polygon = c.colliders[i].polygon;
+        polygon.xs = c.xs.data() + c.first_vertex[i];
+        polygon.ys = c.ys.data() + c.first_vertex[i];
+    }
+
+    c.narrow_phase.run(c.colliders, c.candidates, bounds, c.hits);
+
+    // hits come in ascending asteroid order; remove from the back so that
+    // the swap-with-last removal keeps the remaining indices valid
+    for (auto hit = c.hits.rbegin(); hit != c.hits.rend(); ++hit) {
+        u32 asteroid = hit->b - 1;
+        g_asteroids[asteroid] = g_asteroids[--g_asteroid_count];
+    }
+    if (!c.hits.empty()) {
+        if (g_hud.lives > 0) {
+            --g_hud.lives;
+        }
+        sound_play(g_sounds.ship_explosion, g_ship.position.x, bounds);
+        g_scheduler.spawn(ship_respawn_script(bounds));
+    }
+
+    g_bullets.for_each([&](engine::bullets::Bullet& bullet) {
+        for (u32 i = 0; i < g_asteroid_count; ++i) {
+            const Asteroid& asteroid = g_asteroids[i];
+            bool hit = engine::world::circles_overlap(
+                static_cast<s32>(bullet.position.x),
+                static_cast<s32>(bullet.position.y),
+                0,
+                static_cast<s32>(asteroid.position.x),
+                static_cast<s32>(asteroid.position.y),
+                static_cast<s32>(asteroid.scale),
+                bounds
+            );
+            if (hit) {
+                bullet.alive = false;
+                g_hud.score += asteroid_points(asteroid);
+                sound_play(
+                    g_sounds.rock_explosion,
+                    asteroid.position.x,
+                    bounds,
+                    0.7f
+                );
+                g_asteroids[i] = g_asteroids[--g_asteroid_count];
+                break;
+            }
+        }
+    });
+
+    if (g_asteroid_count == 0 && !g_wave_pending) {
+        g_scheduler.spawn(next_wave_script(bounds));
+    }
 }
 
-static void screen_buffer_fill(ScreenBuffer& screen_buffer, ARGB color)
+//============================================================================
+// Metrics
+//============================================================================
+//
+// Timings are recorded every tick; a summary is published to a shared
+// memory page once per second and/or dumped to a JSON file every few
+// seconds when asked for on the command line.
+//
+
+struct FrameMetrics {
+    engine::metrics::Histogram* frame_time;
+    engine::metrics::Histogram* update_time;
+    engine::metrics::Histogram* render_time;
+    engine::metrics::Histogram* blit_time;
+    engine::metrics::Counter* ticks;
+    engine::metrics::Counter* ticks_missed;
+    engine::metrics::Gauge* asteroids;
+    engine::metrics::Gauge* bullets;
+    engine::metrics::Gauge* quality_level;
+    engine::metrics::Gauge* quality_load_percent;
+    engine::metrics::Counter* quality_downgrades;
+    engine::metrics::Counter* quality_upgrades;
+    engine::metrics::Histogram* snapshot_time;
+    engine::metrics::Histogram* restore_time;
+    engine::metrics::Histogram* audio_mix_time;
+};
+
+struct MetricsExport {
+    engine::memory::SharedMapping page;
+    std::string page_name;
+    engine::metrics::JsonFileWriter json_writer;
+    // counts calls rather than using g_tick, which rewind moves backwards
+    u64 ticks;
+};
+
+static constexpr u64 METRICS_JSON_INTERVAL_TICKS = 5 * TICKS_PER_SECOND;
+
+static engine::metrics::Registry g_metrics{};
+static FrameMetrics g_frame_metrics{
+    &g_metrics.histogram("frame_time_ns"),
+    &g_metrics.histogram("update_time_ns"),
+    &g_metrics.histogram("render_time_ns"),
+    &g_metrics.histogram("blit_time_ns"),
+    &g_metrics.counter("ticks"),
+    &g_metrics.counter("ticks_missed"),
+    &g_metrics.gauge("asteroids"),
+    &g_metrics.gauge("bullets"),
+    &g_metrics.gauge("quality_level"),
+    &g_metrics.gauge("quality_load_percent"),
+    &g_metrics.counter("quality_downgrades"),
+    &g_metrics.counter("quality_upgrades"),
+    &g_metrics.histogram("snapshot_time_ns"),
+    &g_metrics.histogram("restore_time_ns"),
+    &g_metrics.histogram("audio_mix_time_ns"),
+};
+static MetricsExport g_metrics_export{};
+
+static void metrics_export()
 {
-    for (u64 i = 0; i < screen_buffer.pixels_size; ++i) {
-        screen_buffer.pixels[i] = color;
+    auto& e = g_metrics_export;
+    ++e.ticks;
+    if (e.page.data != nullptr && e.ticks % TICKS_PER_SECOND == 0) {
+        auto* page = static_cast<engine::metrics::MetricsPage*>(e.page.data);
+        g_metrics.publish(*page);
+    }
+
+    if (e.json_writer.is_running() &&
+        e.ticks % METRICS_JSON_INTERVAL_TICKS == 0) {
+        e.json_writer.submit(g_metrics);
     }
 }
 
-static void screen_buffer_fill_random(ScreenBuffer& screen_buffer)
+//============================================================================
+// Quality
+//============================================================================
+//
+// Unless a level is pinned on the command line, the governor watches the
+// update and render time of each tick and moves between the presets to
+// hold the tick budget.
+//
+
+static bool g_quality_auto{true};
+static engine::quality::QualityGovernor g_governor{
+    {
+        engine::time::Duration::of(1000000000 / TICKS_PER_SECOND), // budget
+        QUALITY_LEVELS,   // levels
+        TICKS_PER_SECOND, // window_ticks
+        0.85f,            // downgrade_load
+        0.5f,             // upgrade_load
+        3,                // upgrade_windows
+    },
+    QUALITY_LEVELS - 1
+};
+
+static void quality_apply(u32 level)
 {
-    ARGB argb = argb_create_random();
-    screen_buffer_fill(screen_buffer, argb);
+    g_quality_level = level;
+    particles_fit_budget(world_bounds());
+    g_frame_metrics.quality_level->set(level);
 }
 
-static void screen_buffer_blit(HDC device_context, ScreenBuffer& screen_buffer)
+static void quality_update(engine::time::Duration work)
 {
-    // prepare the bitmap
-    HDC memory_dc = CreateCompatibleDC(device_context);
-    HBITMAP bitmap = CreateCompatibleBitmap(
-        device_context,
-        screen_buffer.width,
-        screen_buffer.height
-    );
-    SelectObject(memory_dc, bitmap);
+    if (!g_quality_auto) {
+        return;
+    }
 
-    // transfer the pixel data to the bitmap
-    SetDIBits(
-        memory_dc,                  // target; device context
-        bitmap,                     // target; i.e. bitmap to be altered
-        0,                          // start scan line
-        screen_buffer.scanlines,    // number of scan lines
-        screen_buffer.pixels,       // source
-        &screen_buffer.bitmap_info, // bitmap info
-        DIB_RGB_COLORS              // literal RGB values
+    bool changed = g_governor.observe(work);
+    g_frame_metrics.quality_load_percent->set(
+        static_cast<s64>(g_governor.load() * 100.0f)
     );
+    if (!changed) {
+        return;
+    }
 
-    MUSTE(BitBlt(
-        device_context,       // dest DC
-        0,                    // dest upper-left X
-        0,                    // dest upper-left Y
-        screen_buffer.width,  // dest and src rect width
-        screen_buffer.height, // dest and src rect height
-        memory_dc,            // src
-        0,                    // src upper-left X
-        0,                    // src upper-left Y
-        SRCCOPY
-    ));
-
-    // clean up
-    DeleteObject(bitmap);
-    DeleteDC(memory_dc);
+    if (g_governor.level() < g_quality_level) {
+        g_frame_metrics.quality_downgrades->add();
+    } else {
+        g_frame_metrics.quality_upgrades->add();
+    }
+    quality_apply(g_governor.level());
 }
 
 //============================================================================
-// Game
+// Snapshots
 //============================================================================
+//
+// Every few ticks the simulation state is copied into g_snapshots; while
+// the rewind button is held, each tick steps back to the previous snapshot
+// instead of simulating. Input is live state and is not rewound.
+//
+// The state that is not trivially copyable, the timer wheel and the random
+// generator, is kept in a parallel array of the same slots. Script
+// coroutines cannot be copied at all, so a restore cancels the running
+// scripts and starts the ones the restored state is waiting for afresh;
+// their delays start over.
+//
 
-struct Particle {
-    s32 x{};
-    s32 y{};
-    ARGB color{};
-    s32 velocity_x{};
-    s32 velocity_y{};
-    engine::time::Instant birth_time{};
-    u32 flags{};
+struct WorldSnapshot {
+    u64 game_time_ns;
+    AmbientParticles particles;
+    Ship ship;
+    u32 asteroid_count;
+    Asteroid asteroids[MAX_ASTEROIDS];
+    engine::bullets::BulletPool<MAX_BULLETS> bullets;
+    bool gun_ready;
+    bool wave_pending;
+    u32 wave;
+    u32 score;
+    u32 lives;
 };
 
-static constexpr u32 MAX_PARTICLES = 100;
-static Particle g_particles[MAX_PARTICLES];
-
-static void particles_init(ScreenBuffer& screen_buffer)
-{
-    auto screen_width = static_cast<u32>(screen_buffer.width);
-    auto screen_height = static_cast<u32>(screen_buffer.height);
-
-    auto birth_time = engine::time::Instant::now();
-    for (u32 i = 0; i < MAX_PARTICLES; ++i) {
-        s32 x = engine::prng::random<s32>(static_cast<s32>(screen_width), 0);
-        s32 y = engine::prng::random<s32>(static_cast<s32>(screen_height), 0);
-        s32 velocity_x = engine::prng::random<s32>(2, -2);
-        s32 velocity_y = engine::prng::random<s32>(2, -2);
-        auto color = argb_create_random();
-        g_particles[i] = {
-            x,          // x
-            y,          // y
-            color,      // color
-            velocity_x, // velocity_x
-            velocity_y, // velocity_y
-            birth_time, // birth_time
-            0           // flags
-        };
-    }
+struct SnapshotExtras {
+    engine::timers::TimerWheel timers;
+    std::mt19937_64 prng;
+};
+
+static constexpr u64 SNAPSHOT_INTERVAL_TICKS = 5;
+// about 20 seconds of rewind
+static constexpr u32 SNAPSHOT_CAPACITY = 128;
+
+static engine::snapshots::SnapshotRing<WorldSnapshot> g_snapshots{
+    SNAPSHOT_CAPACITY
+};
+static std::vector<SnapshotExtras> g_snapshot_extras(
+    SNAPSHOT_CAPACITY,
+    {g_timers, {}}
+);
+
+static void snapshot_capture()
+{
+    auto start = engine::time::Instant::now();
+
+    u32 slot = g_snapshots.push(g_tick);
+    WorldSnapshot& s = g_snapshots.at(slot);
+    s.game_time_ns = g_game_time_ns;
+    s.particles = g_particles;
+    s.ship = g_ship;
+    s.asteroid_count = g_asteroid_count;
+    std::copy_n(g_asteroids, g_asteroid_count, s.asteroids);
+    s.bullets = g_bullets;
+    s.gun_ready = g_gun_ready;
+    s.wave_pending = g_wave_pending;
+    s.wave = g_wave;
+    s.score = g_hud.score;
+    s.lives = g_hud.lives;
+
+    SnapshotExtras& extras = g_snapshot_extras[slot];
+    extras.timers = g_timers;
+    extras.prng = engine::prng::PrngSource::instance().generator();
+
+    g_frame_metrics.snapshot_time->record(engine::time::Duration::from(start));
 }
 
-static void particles_draw(ScreenBuffer& screen_buffer)
+/**
+ * Restarts the scripts the current state is waiting for; see the section
+ * comment.
+ */
+static void scripts_restart(engine::world::WorldBounds bounds)
 {
-    for (u32 i = 0; i < MAX_PARTICLES; ++i) {
-        Particle& particle = g_particles[i];
-        screen_buffer_draw_pixel(
-            screen_buffer,
-            particle.x,
-            particle.y,
-            particle.color
-        );
+    g_scheduler.cancel_all();
+    if (!g_ship.alive) {
+        g_scheduler.spawn(ship_respawn_script(bounds));
+    } else if (g_ship.invulnerable) {
+        g_scheduler.spawn(ship_invulnerable_script());
+    }
+    if (g_wave_pending) {
+        g_scheduler.spawn(next_wave_script(bounds));
     }
 }
 
-static void particles_update()
+static void snapshot_restore(u32 slot)
 {
-    for (u32 i = 0; i < MAX_PARTICLES; ++i) {
-        Particle& particle = g_particles[i];
+    auto start = engine::time::Instant::now();
 
-        particle.x += particle.velocity_x;
-        if (particle.x < 0) {
-            particle.x = 0;
-            particle.velocity_x = -particle.velocity_x;
-        } else if (particle.x >= g_screen_buffer.width) {
-            particle.x = g_screen_buffer.width - 1;
-            particle.velocity_x = -particle.velocity_x;
-        }
+    const WorldSnapshot& s = g_snapshots.at(slot);
+    g_tick = g_snapshots.tick(slot);
+    g_game_time_ns = s.game_time_ns;
+    g_particles = s.particles;
+    g_ship = s.ship;
+    g_asteroid_count = s.asteroid_count;
+    std::copy_n(s.asteroids, s.asteroid_count, g_asteroids);
+    g_bullets = s.bullets;
+    g_gun_ready = s.gun_ready;
+    g_wave_pending = s.wave_pending;
+    g_wave = s.wave;
+    g_hud.score = s.score;
+    g_hud.lives = s.lives;
 
-        particle.y += particle.velocity_y;
-        if (particle.y < 0) {
-            particle.y = 0;
-            particle.velocity_y = -particle.velocity_y;
-        } else if (particle.y >= g_screen_buffer.height) {
-            particle.y = g_screen_buffer.height - 1;
-            particle.velocity_y = -particle.velocity_y;
-        }
+    const SnapshotExtras& extras = g_snapshot_extras[slot];
+    g_timers = extras.timers;
+    engine::prng::PrngSource::instance().generator() = extras.prng;
+
+    scripts_restart(world_bounds());
+    g_frame_metrics.restore_time->record(engine::time::Duration::from(start));
+}
+
+/**
+ * Steps back to the newest snapshot before the current tick. The restored
+ * snapshot is dropped as well, so that the next step goes further back.
+ */
+static void snapshot_rewind()
+{
+    u32 slot = g_snapshots.find(g_tick - 1);
+    if (slot == g_snapshots.NONE) {
+        // nothing left to rewind to; hold still
+        --g_tick;
+        return;
     }
+    snapshot_restore(slot);
+    g_snapshots.drop_after(g_tick - 1);
 }
 
-static void game_update([[maybe_unused]] engine::time::Duration delta)
+//============================================================================
+// Game loop
+//============================================================================
+
+static void game_update(engine::time::Duration delta)
 {
-    DEBUG_PRINT(std::format(
-                    "previous UPDATE was {} ms ago\n",
-                    delta.value(engine::time::TimeUnit::MILLISECONDS)
-    )
-                    .c_str());
+    auto tick_end = engine::time::Instant::now();
+    if (g_input_queue.drain(++g_tick, tick_end, g_input) > 0) {
+        g_player_control = true;
+    }
+    if (g_input.is_held(engine::input::BUTTON_REWIND)) {
+        snapshot_rewind();
+        return;
+    }
+
+    g_game_time_ns += delta.nanosecond_value();
+    auto now = engine::time::Instant::of(g_game_time_ns);
+
+    particles_update(world_bounds());
+    g_scheduler.tick(delta);
+    g_timers.advance();
 
-    particles_update();
+    ship_update(world_bounds(), now);
+    starfield_update();
+    asteroids_update(world_bounds());
+    bullets_update(world_bounds(), now);
+    collisions_update(world_bounds());
+
+    g_frame_metrics.asteroids->set(g_asteroid_count);
+    g_frame_metrics.bullets->set(g_bullets.count());
+
+    if (g_tick % SNAPSHOT_INTERVAL_TICKS == 0) {
+        snapshot_capture();
+    }
 }
 
 static void game_render(
@@ -248,15 +1451,114 @@ static void game_render(
     ScreenBuffer& screen_buffer
 )
 {
-    DEBUG_PRINT(std::format(
-                    "previous RENDER was {} ms ago\n",
-                    delta.value(engine::time::TimeUnit::MILLISECONDS)
-    )
-                    .c_str());
+    // the world goes into the render target; the HUD is drawn afterwards at
+    // full resolution so that text stays sharp
+    ScreenBuffer& target = render_target();
 
     static ARGB black = argb_create(0x00, 0x00, 0x00);
-    screen_buffer_fill(screen_buffer, black);
-    particles_draw(screen_buffer);
+    auto& dirty = dirty_regions(target);
+    if (starfield_draw(target)) {
+        // the background scrolls, so it covers the whole target anyway
+        dirty.reset(target);
+    } else if (g_render_settings.dirty_erase) {
+        dirty.erase(target, black);
+    } else {
+        dirty.clear(target, black);
+    }
+    particles_draw(target, dirty);
+    objects_draw(target, dirty);
+    bullets_draw(target, dirty);
+
+    if (&target != &screen_buffer) {
+        auto filter = quality().smooth_upscale ? g_render_settings.filter :
+                                                 engine::graphics::NEAREST;
+        g_upscaler.upscale(target, screen_buffer, filter);
+    }
+
+    // the upscale overwrote the whole screen buffer anyway
+    bool hud_in_target = &target == &screen_buffer;
+    hud_draw(delta, screen_buffer, hud_in_target ? &dirty : nullptr);
+}
+
+//============================================================================
+// Training workload
+//============================================================================
+//
+// `--train <ticks>` runs a fixed number of ticks back to back with the
+// window hidden. The random generator gets a fixed seed and the input comes
+// from a looping script, so every run does the same work; the profile
+// guided builds (see CMakePresets.json) use it as their training run. The
+// time taken goes to training.txt, or the file given with --train-report.
+//
+
+static constexpr u64 TRAINING_SEED = 0x7ea1;
+static constexpr u64 TRAINING_PERIOD_TICKS = 240;
+// the hidden window's client area depends on the desktop, so training
+// renders at a size of its own
+static constexpr s32 TRAINING_WIDTH = 800;
+static constexpr s32 TRAINING_HEIGHT = 600;
+
+// turns, thrusts and shoots in bursts, then rewinds a second of it
+static constexpr engine::input::ScriptedInput TRAINING_SCRIPT[] = {
+    {0, engine::input::BUTTON_FIRE, true},
+    {10, engine::input::BUTTON_LEFT, true},
+    {40, engine::input::BUTTON_LEFT, false},
+    {40, engine::input::BUTTON_THRUST, true},
+    {70, engine::input::BUTTON_THRUST, false},
+    {70, engine::input::BUTTON_RIGHT, true},
+    {120, engine::input::BUTTON_RIGHT, false},
+    {150, engine::input::BUTTON_FIRE, false},
+    {160, engine::input::BUTTON_REWIND, true},
+    {190, engine::input::BUTTON_REWIND, false},
+    {200, engine::input::BUTTON_THRUST, true},
+    {200, engine::input::BUTTON_FIRE, true},
+    {230, engine::input::BUTTON_THRUST, false},
+    {230, engine::input::BUTTON_FIRE, false},
+};
+
+static u64 g_training_ticks{0};
+static std::filesystem::path g_training_report{"training.txt"};
+
+static void training_run(ScreenBuffer& screen_buffer)
+{
+    const auto delta =
+        engine::time::Duration::of(1000000000 / TICKS_PER_SECOND);
+    engine::input::InputInjector injector{
+        TRAINING_SCRIPT,
+        TRAINING_PERIOD_TICKS
+    };
+
+    u64 rewind_ticks = 0;
+    auto stopwatch = engine::time::Stopwatch::start();
+    for (u64 i = 0; i < g_training_ticks; ++i) {
+        // the script runs on the loop count; g_tick goes backwards while
+        // rewinding and would never reach the release of the rewind button
+        auto now = engine::time::Instant::now();
+        injector.inject(i + 1, now, g_input_queue);
+        game_update(delta);
+        game_render(delta, screen_buffer);
+        g_frame_metrics.ticks->add();
+        if (g_input.is_held(engine::input::BUTTON_REWIND)) {
+            ++rewind_ticks;
+        }
+    }
+    u64 elapsed_ns = stopwatch.split().nanosecond_value();
+
+    // a windows subsystem program has no console to print to
+    auto report = std::format(
+        "ticks {}\nrewind_ticks {}\nresolution {}x{}\nquality {}\n"
+        "time_ms {:.1f}\ntick_us {:.1f}\n",
+        g_training_ticks,
+        rewind_ticks,
+        screen_buffer.width,
+        screen_buffer.height,
+        g_quality_level,
+        static_cast<f64>(elapsed_ns) / 1e6,
+        static_cast<f64>(elapsed_ns) / 1e3 /
+            static_cast<f64>(g_training_ticks)
+    );
+    std::ofstream file{g_training_report, std::ios::binary | std::ios::trunc};
+    file.write(report.data(), static_cast<std::streamsize>(report.size()));
 }
 
 //============================================================================
@@ -287,23 +1589,50 @@ static LRESULT CALLBACK window_procedure(
     return DefWindowProc(window, message, wParam, lParam);
 }
 
-static void win32_message_pump()
+static auto win32_button(WPARAM virtual_key) -> std::optional<Button>
 {
-    const u16 max_events_per_cycle = 20;
-    for (u16 i = 0; i < max_events_per_cycle; ++i) {
-        MSG message;
-        bool had_message = PeekMessage(&message, 0, 0, 0, PM_REMOVE);
-        if (!had_message) {
-            // no messages; break out of the loop
-            break;
-        }
+    switch (virtual_key) {
+        case VK_LEFT:
+            return engine::input::BUTTON_LEFT;
+        case VK_RIGHT:
+            return engine::input::BUTTON_RIGHT;
+        case VK_UP:
+            return engine::input::BUTTON_THRUST;
+        case VK_SPACE:
+            return engine::input::BUTTON_FIRE;
+        case VK_BACK:
+            return engine::input::BUTTON_REWIND;
+        default:
+            return std::nullopt;
+    }
+}
 
-        // handle special events that never reach the window procedure
+/**
+ * Drains the whole message queue; keyboard input is turned into timestamped
+ * button events for the game, everything else goes to the window procedure.
+ */
+static void win32_message_pump()
+{
+    MSG message;
+    while (PeekMessage(&message, 0, 0, 0, PM_REMOVE)) {
         switch (message.message) {
+            // handle special events that never reach the window procedure
             case WM_QUIT:
                 g_run_game = false;
                 break;
 
+            case WM_KEYDOWN:
+            case WM_KEYUP:
+                if (auto button = win32_button(message.wParam)) {
+                    g_input_queue.push({
+                        engine::time::Instant::now(), // timestamp
+                        *button,                      // button
+                        message.message == WM_KEYDOWN // pressed
+                    });
+                    break;
+                }
+                [[fallthrough]];
+
             default:
                 // let the window procedure handle the message
                 TranslateMessage(&message);
@@ -312,6 +1641,176 @@ static void win32_message_pump()
     }
 }
 
+/**
+ * Command line arguments without the program name, split by the same rules
+ * as the C runtime's argv.
+ */
+static auto win32_arguments() -> const std::vector<std::wstring>&
+{
+    static const std::vector<std::wstring> arguments = [] {
+        std::vector<std::wstring> result;
+        int count = 0;
+        LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &count);
+        if (argv != nullptr) {
+            for (int i = 1; i < count; ++i) {
+                result.emplace_back(argv[i]);
+            }
+            LocalFree(argv);
+        }
+        return result;
+    }();
+    return arguments;
+}
+
+/** Value of a "--name value" option; the name must match a whole argument. */
+static auto win32_option(std::wstring_view name)
+    -> std::optional<std::wstring_view>
+{
+    const auto& arguments = win32_arguments();
+    auto option = std::find(arguments.begin(), arguments.end(), name);
+    if (option == arguments.end() || option + 1 == arguments.end()) {
+        return std::nullopt;
+    }
+    return *(option + 1);
+}
+
+static void win32_parse_render_settings()
+{
+    if (auto downscale = win32_option(L"--render-downscale")) {
+        s32 value = 0;
+        for (wchar_t digit : *downscale) {
+            if (digit < L'0' || digit > L'9') {
+                value = 0;
+                break;
+            }
+            value = value * 10 + (digit - L'0');
+        }
+        g_render_settings.downscale = std::clamp(value, 1, 8);
+    }
+
+    if (auto filter = win32_option(L"--render-filter")) {
+        g_render_settings.filter = *filter == L"bilinear" ?
+                                       engine::graphics::BILINEAR :
+                                       engine::graphics::NEAREST;
+    }
+
+    if (auto clear = win32_option(L"--render-clear")) {
+        g_render_settings.dirty_erase = *clear != L"full";
+    }
+
+    if (auto starfield = win32_option(L"--starfield")) {
+        g_render_settings.starfield = *starfield == L"on";
+    }
+
+    // a level pins the quality; anything else (e.g. "auto") keeps the
+    // governor in charge
+    if (auto level = win32_option(L"--quality")) {
+        if (level->size() == 1 && (*level)[0] >= L'0' &&
+            static_cast<u32>((*level)[0] - L'0') < QUALITY_LEVELS) {
+            g_quality_level = static_cast<u32>((*level)[0] - L'0');
+            g_quality_auto = false;
+        }
+    }
+}
+
+/**
+ * Narrows an option value; paths and segment names are expected to be
+ * plain ASCII.
+ */
+static auto win32_narrow(std::wstring_view value) -> std::string
+{
+    std::string narrow;
+    for (wchar_t c : value) {
+        narrow += static_cast<char>(c);
+    }
+    return narrow;
+}
+
+/**
+ * A training run pins the quality level, so that the governor does not
+ * make the work depend on the speed of the machine.
+ */
+static void win32_parse_training_settings()
+{
+    auto ticks = win32_option(L"--train");
+    if (!ticks) {
+        return;
+    }
+
+    u64 value = 0;
+    for (wchar_t digit : *ticks) {
+        if (digit < L'0' || digit > L'9') {
+            value = 0;
+            break;
+        }
+        value = value * 10 + static_cast<u64>(digit - L'0');
+    }
+    g_training_ticks = value;
+    if (auto report = win32_option(L"--train-report")) {
+        g_training_report = std::filesystem::path{*report};
+    }
+    if (g_training_ticks > 0) {
+        engine::prng::PrngSource::instance().set_fixed_seed(TRAINING_SEED);
+        g_quality_auto = false;
+    }
+}
+
+static void win32_parse_metrics_settings()
+{
+    auto& e = g_metrics_export;
+    if (auto json_path = win32_option(L"--metrics-json")) {
+        // MUST would only check this in debug builds
+        if (!e.json_writer.start(std::filesystem::path{*json_path})) {
+            PANICM("cannot create the --metrics-json file");
+        }
+    }
+
+    if (auto page_name = win32_option(L"--metrics-shm")) {
+        e.page_name = win32_narrow(*page_name);
+        e.page = engine::memory::create_shared_memory(
+            e.page_name,
+            sizeof(engine::metrics::MetricsPage)
+        );
+    }
+}
+
+/**
+ * Plays through the sound card unless told otherwise. A machine without
+ * one runs the mixer into the null sink, so the game behaves the same.
+ */
+static void win32_start_audio()
+{
+    constexpr u32 RATE = engine::audio::AudioMixer::SAMPLE_RATE;
+    constexpr u32 BLOCK_FRAMES = engine::audio::AudioMixer::BLOCK_FRAMES;
+
+    auto audio = win32_option(L"--audio");
+    if (audio && *audio == L"off") {
+        return;
+    }
+
+    // MUST would only check these in debug builds, and a sink that failed
+    // to open leaves the mixer without output
+    bool null_sink = false;
+    if (auto wav_path = win32_option(L"--audio-wav")) {
+        if (!g_audio_sink.open_wav(std::filesystem::path{*wav_path}, RATE)) {
+            PANICM("cannot create the --audio-wav file");
+        }
+    } else if (g_training_ticks > 0) {
+        // the mixer still runs, but nothing is heard
+        null_sink = true;
+    } else if (!g_audio_sink.open_device(RATE, BLOCK_FRAMES)) {
+        null_sink = true;
+    }
+    if (null_sink && !g_audio_sink.open_null(RATE)) {
+        PANICM("cannot open the null audio sink");
+    }
+
+    sounds_init();
+    if (!g_audio_mixer.start(g_audio_sink, g_frame_metrics.audio_mix_time)) {
+        PANICM("cannot start the audio mixer");
+    }
+}
+
 int APIENTRY _tWinMain(
     HINSTANCE instance,
     [[maybe_unused]] HINSTANCE prev_instance,
@@ -348,12 +1847,83 @@ int APIENTRY _tWinMain(
         NULL                 // Additional application data
     ));
 
-    ShowWindow(window, cmd_show);
+    win32_parse_training_settings();
+    if (g_training_ticks == 0) {
+        ShowWindow(window, cmd_show);
+    }
+
+    s32 width = TRAINING_WIDTH;
+    s32 height = TRAINING_HEIGHT;
+    if (g_training_ticks == 0) {
+        RECT rect{};
+        MUSTE(GetClientRect(window, &rect));
+        width = rect.right - rect.left;
+        height = rect.bottom - rect.top;
+    }
+    screen_buffer_init(g_screen_buffer, g_bitmap_info, width, height);
+
+    // --quality picks the level of a training run too
+    win32_parse_render_settings();
+    g_world_bounds = {
+        std::max(g_screen_buffer.width / g_render_settings.downscale, 1),
+        std::max(g_screen_buffer.height / g_render_settings.downscale, 1),
+    };
+    for (u32 shift = 0; shift < std::size(g_render_buffers); ++shift) {
+        if (g_render_settings.downscale > 1 || shift > 0) {
+            engine::graphics::screen_buffer_allocate(
+                g_render_buffers[shift],
+                std::max(g_world_bounds.width >> shift, 1),
+                std::max(g_world_bounds.height >> shift, 1)
+            );
+        }
+    }
+
+    if (auto assets = win32_option(L"--assets")) {
+        if (!g_assets.open(win32_narrow(*assets).c_str())) {
+            PANICM("cannot open the --assets archive");
+        }
+    }
+
+    g_frame_metrics.quality_level->set(g_quality_level);
+    particles_init(world_bounds());
+    meshes_init();
+    if (g_render_settings.starfield) {
+        g_starfield.init(STAR_LAYERS);
+    }
+    hulls_init();
+    asteroids_init(world_bounds());
+    hud_init();
+
+    engine::time::TickLimiter tick_limiter{TICKS_PER_SECOND};
+
+    if (auto capture_path = win32_option(L"--capture")) {
+        if (!g_frame_capture.start(
+                std::filesystem::path{*capture_path},
+                g_screen_buffer.width,
+                g_screen_buffer.height,
+                TICKS_PER_SECOND
+            )) {
+            PANICM("cannot start the --capture recording");
+        }
+    }
+
+    if (auto export_name = win32_option(L"--export-frames")) {
+        if (!g_frame_export.start(
+                win32_narrow(*export_name),
+                g_screen_buffer.width,
+                g_screen_buffer.height
+            )) {
+            PANICM("cannot create the --export-frames ring");
+        }
+    }
 
-    screen_buffer_init(window, g_screen_buffer);
-    particles_init(g_screen_buffer);
+    win32_parse_metrics_settings();
+    win32_start_audio();
 
-    engine::time::TickLimiter tick_limiter{30};
+    if (g_training_ticks > 0) {
+        training_run(g_screen_buffer);
+        g_run_game = false;
+    }
 
     while (g_run_game) {
         auto stopwatch = engine::time::Stopwatch::start();
@@ -364,10 +1934,51 @@ int APIENTRY _tWinMain(
         bool screen_redraw_needed = false;
         if (tick_limiter.should_tick()) {
             auto delta = tick_limiter.time_from_last_tick();
+            g_frame_metrics.ticks->add();
+            g_frame_metrics.frame_time->record(delta);
+            if (tick_limiter.tick_missed()) {
+                g_frame_metrics.ticks_missed->add();
+            }
 
+            // printed here rather than in game_update/game_render, so that
+            // neither the training run nor the timings include it
+            DEBUG_PRINT(std::format(
+                            "previous UPDATE was {} ms ago\n",
+                            delta.value(engine::time::TimeUnit::MILLISECONDS)
+            )
+                            .c_str());
+            auto update_stopwatch = engine::time::Stopwatch::start();
             game_update(delta);
+            auto update_time = update_stopwatch.split();
+            g_frame_metrics.update_time->record(update_time);
 
+            if (g_frame_export.is_running()) {
+                g_screen_buffer.pixels = g_frame_export.begin_frame();
+            }
+
+            DEBUG_PRINT(std::format(
+                            "previous RENDER was {} ms ago\n",
+                            delta.value(engine::time::TimeUnit::MILLISECONDS)
+            )
+                            .c_str());
+            auto render_stopwatch = engine::time::Stopwatch::start();
             game_render(delta, g_screen_buffer);
+            auto render_time = render_stopwatch.split();
+            g_frame_metrics.render_time->record(render_time);
+
+            quality_update(engine::time::Duration::of(
+                update_time.nanosecond_value() +
+                render_time.nanosecond_value()
+            ));
+
+            if (g_frame_capture.is_running()) {
+                g_frame_capture.submit(g_screen_buffer);
+            }
+            if (g_frame_export.is_running()) {
+                g_frame_export.end_frame();
+            }
+
+            metrics_export();
 
             tick_limiter.tick();
             screen_redraw_needed = true;
@@ -376,9 +1987,11 @@ int APIENTRY _tWinMain(
         // when screen redraw is needed render the contents of the screen
         // buffer into window
         if (screen_redraw_needed) {
+            auto blit_stopwatch = engine::time::Stopwatch::start();
             HDC window_dc = MUST(GetDC(window));
-            screen_buffer_blit(window_dc, g_screen_buffer);
+            screen_buffer_blit(window_dc, g_screen_buffer, g_bitmap_info);
             ReleaseDC(window, window_dc);
+            g_frame_metrics.blit_time->record(blit_stopwatch.split());
         }
 
         /*DEBUG_PRINT(
@@ -388,5 +2001,15 @@ int APIENTRY _tWinMain(
         // Sleep(500);
     }
 
+    g_audio_mixer.stop();
+    g_audio_sink.close();
+    g_frame_capture.stop();
+    g_frame_export.stop();
+    g_metrics_export.json_writer.stop();
+    engine::memory::release_shared_memory(
+        g_metrics_export.page,
+        g_metrics_export.page_name
+    );
+
     return 0;
 }
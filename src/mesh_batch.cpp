@@ -0,0 +1,195 @@
+#include "mesh_batch.h"
+#include "simd.h"
+#include <algorithm>
+#include <cmath>
+
+namespace engine::graphics {
+
+//===========================================================================
+// MeshLibrary
+//===========================================================================
+
+auto MeshLibrary::add(std::span<const math::vec2> vertices) -> MeshId
+{
+    auto id = static_cast<MeshId>(meshes_.size());
+
+    f32 radius_squared = 0.0f;
+    for (auto vertex : vertices) {
+        xs_.push_back(vertex.x);
+        ys_.push_back(vertex.y);
+        radius_squared = std::max(radius_squared, math::length_squared(vertex));
+    }
+
+    meshes_.push_back({
+        static_cast<u32>(xs_.size() - vertices.size()), // first_vertex
+        static_cast<u32>(vertices.size()),              // vertex_count
+        std::sqrt(radius_squared),                      // radius
+    });
+    return id;
+}
+
+//===========================================================================
+// MeshBatch
+//===========================================================================
+
+void MeshBatch::clear()
+{
+    xs_.clear();
+    ys_.clear();
+    block_matrices_.clear();
+    matrices_.clear();
+    objects_.clear();
+}
+
+void MeshBatch::add(
+    const MeshLibrary& library,
+    const MeshInstance& instance,
+    world::WorldBounds bounds
+)
+{
+    f32 radius = library.mesh(instance.mesh).radius * instance.scale;
+    auto x = static_cast<s32>(instance.position.x);
+    auto y = static_cast<s32>(instance.position.y);
+    auto reach = static_cast<s32>(radius) + 1;
+
+    world::for_each_image(x, y, reach, bounds, [&](s32 image_x, s32 image_y) {
+        math::vec2 offset{
+            static_cast<f32>(image_x - x),
+            static_cast<f32>(image_y - y),
+        };
+        math::vec2 position = instance.position + offset;
+
+        // cull images that cannot touch the world
+        bool visible = position.x + radius >= 0.0f &&
+                       position.y + radius >= 0.0f &&
+                       position.x - radius < static_cast<f32>(bounds.width) &&
+                       position.y - radius < static_cast<f32>(bounds.height);
+        if (visible) {
+            add_image(library, instance, position);
+        }
+    });
+}
+
+void MeshBatch::add_image(
+    const MeshLibrary& library,
+    const MeshInstance& instance,
+    math::vec2 position
+)
+{
+    const auto& mesh = library.mesh(instance.mesh);
+    if (mesh.vertex_count == 0) {
+        return;
+    }
+
+    auto matrix = static_cast<u32>(matrices_.size());
+    matrices_.push_back(math::mat2x3::from_transform(
+        position,
+        instance.rotation,
+        instance.scale
+    ));
+
+    auto first_vertex = static_cast<u32>(xs_.size());
+    objects_.push_back({first_vertex, mesh.vertex_count, instance.color});
+
+    const f32* xs = library.xs() + mesh.first_vertex;
+    const f32* ys = library.ys() + mesh.first_vertex;
+    xs_.insert(xs_.end(), xs, xs + mesh.vertex_count);
+    ys_.insert(ys_.end(), ys, ys + mesh.vertex_count);
+
+    // pad the run by repeating the last vertex so that the next object
+    // starts a new block
+    u32 padded_count = (mesh.vertex_count + BLOCK_SIZE - 1) & ~(BLOCK_SIZE - 1);
+    xs_.resize(first_vertex + padded_count, xs[mesh.vertex_count - 1]);
+    ys_.resize(first_vertex + padded_count, ys[mesh.vertex_count - 1]);
+    u32 block_count = padded_count / BLOCK_SIZE;
+    block_matrices_.insert(block_matrices_.end(), block_count, matrix);
+}
+
+void MeshBatch::transform()
+{
+    world_xs_.resize(xs_.size());
+    world_ys_.resize(ys_.size());
+
+    const f32* xs = xs_.data();
+    const f32* ys = ys_.data();
+    f32* out_xs = world_xs_.data();
+    f32* out_ys = world_ys_.data();
+
+    auto block_count = static_cast<u32>(block_matrices_.size());
+    for (u32 block = 0; block < block_count; ++block) {
+        const auto& m = matrices_[block_matrices_[block]];
+        u32 i = block * BLOCK_SIZE;
+
+#if defined(ENGINE_SIMD_SSE2)
+        __m128 x = _mm_loadu_ps(xs + i);
+        __m128 y = _mm_loadu_ps(ys + i);
+        __m128 tx = _mm_add_ps(
+            _mm_add_ps(
+                _mm_mul_ps(_mm_set1_ps(m.m00), x),
+                _mm_mul_ps(_mm_set1_ps(m.m01), y)
+            ),
+            _mm_set1_ps(m.m02)
+        );
+        __m128 ty = _mm_add_ps(
+            _mm_add_ps(
+                _mm_mul_ps(_mm_set1_ps(m.m10), x),
+                _mm_mul_ps(_mm_set1_ps(m.m11), y)
+            ),
+            _mm_set1_ps(m.m12)
+        );
+        _mm_storeu_ps(out_xs + i, tx);
+        _mm_storeu_ps(out_ys + i, ty);
+#else
+        math::transform_points(
+            m,
+            xs + i,
+            ys + i,
+            out_xs + i,
+            out_ys + i,
+            BLOCK_SIZE
+        );
+#endif
+    }
+}
+
+void MeshBatch::draw(ScreenBuffer& screen_buffer) const
+{
+    for (const auto& object : objects_) {
+        const f32* xs = world_xs_.data() + object.first_vertex;
+        const f32* ys = world_ys_.data() + object.first_vertex;
+
+        u32 previous = object.vertex_count - 1;
+        for (u32 i = 0; i < object.vertex_count; ++i) {
+            screen_buffer_draw_line(
+                screen_buffer,
+                xs[previous],
+                ys[previous],
+                xs[i],
+                ys[i],
+                object.color
+            );
+            previous = i;
+        }
+    }
+}
+
+void MeshBatch::mark(DirtyRegions& dirty) const
+{
+    for (const auto& object : objects_) {
+        const f32* xs = world_xs_.data() + object.first_vertex;
+        const f32* ys = world_ys_.data() + object.first_vertex;
+        u32 count = object.vertex_count;
+        auto [min_x, max_x] = std::minmax_element(xs, xs + count);
+        auto [min_y, max_y] = std::minmax_element(ys, ys + count);
+
+        // one pixel of slack for rounding in the rasterizer
+        dirty.mark({
+            static_cast<s32>(std::floor(*min_x)) - 1, // left
+            static_cast<s32>(std::floor(*min_y)) - 1, // top
+            static_cast<s32>(std::ceil(*max_x)) + 2,  // right
+            static_cast<s32>(std::ceil(*max_y)) + 2,  // bottom
+        });
+    }
+}
+
+} // namespace engine::graphics
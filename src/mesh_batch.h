@@ -0,0 +1,153 @@
+#pragma once
+
+#include "core.h"
+#include "dirty_regions.h"
+#include "graphics.h"
+#include "vecmath.h"
+#include "world.h"
+#include <span>
+#include <vector>
+
+namespace engine::graphics {
+
+/** Handle of a mesh stored in a MeshLibrary. */
+using MeshId = u32;
+
+//===========================================================================
+// MeshLibrary
+//===========================================================================
+
+/**
+ * Closed polygon outlines in object space, stored back to back in a single
+ * structure-of-arrays vertex pool.
+ */
+class MeshLibrary final {
+public:
+    DEFAULT_CTOR(MeshLibrary);
+    DEFAULT_DTOR(MeshLibrary);
+    DELETE_COPY(MeshLibrary);
+    DEFAULT_MOVE(MeshLibrary);
+
+    struct Mesh {
+        u32 first_vertex;
+        u32 vertex_count;
+        /** Distance of the farthest vertex from the origin. */
+        f32 radius;
+    };
+
+    auto add(std::span<const math::vec2> vertices) -> MeshId;
+
+    [[nodiscard]] auto mesh(MeshId id) const -> const Mesh&
+    {
+        return meshes_[id];
+    }
+
+    [[nodiscard]] auto mesh_count() const -> u32
+    {
+        return static_cast<u32>(meshes_.size());
+    }
+
+    [[nodiscard]] auto xs() const -> const f32* { return xs_.data(); }
+    [[nodiscard]] auto ys() const -> const f32* { return ys_.data(); }
+
+private:
+    std::vector<f32> xs_{};
+    std::vector<f32> ys_{};
+    std::vector<Mesh> meshes_{};
+};
+
+/**
+ * One object to be drawn: a mesh placed into the world.
+ */
+struct MeshInstance {
+    MeshId mesh;
+    math::vec2 position;
+    f32 rotation;
+    f32 scale;
+    ARGB color;
+};
+
+//===========================================================================
+// MeshBatch
+//===========================================================================
+
+/**
+ * Per-frame vertex pipeline for all outlines.
+ *
+ * Every visible instance is gathered into one SoA vertex stream together
+ * with the index of its object-to-world matrix. The stream is then
+ * transformed in a single vectorized pass and handed to the line
+ * rasterizer. Each object's vertex run is padded to a multiple of the SIMD
+ * width so that every block of vertices shares one matrix.
+ *
+ * The buffers only grow; once warmed up a frame does no allocations.
+ */
+class MeshBatch final {
+public:
+    DEFAULT_CTOR(MeshBatch);
+    DEFAULT_DTOR(MeshBatch);
+    DELETE_COPY(MeshBatch);
+    DEFAULT_MOVE(MeshBatch);
+
+    /** Vertices per block; every block uses a single matrix. */
+    static constexpr u32 BLOCK_SIZE = 4;
+
+    void clear();
+
+    /**
+     * Gathers the instance, plus its wrapped images when it straddles a
+     * world edge. Images completely outside the world are culled.
+     */
+    void add(
+        const MeshLibrary& library,
+        const MeshInstance& instance,
+        world::WorldBounds bounds
+    );
+
+    /** Transforms every gathered vertex into world space. */
+    void transform();
+
+    /** Rasterizes the transformed outlines as closed line loops. */
+    void draw(ScreenBuffer& screen_buffer) const;
+
+    /** Marks the bounding box of every transformed outline. */
+    void mark(DirtyRegions& dirty) const;
+
+    [[nodiscard]] auto object_count() const -> u32
+    {
+        return static_cast<u32>(objects_.size());
+    }
+
+    [[nodiscard]] auto vertex_count() const -> u32
+    {
+        return static_cast<u32>(xs_.size());
+    }
+
+private:
+    struct Object {
+        u32 first_vertex;
+        u32 vertex_count;
+        ARGB color;
+    };
+
+    void add_image(
+        const MeshLibrary& library,
+        const MeshInstance& instance,
+        math::vec2 position
+    );
+
+    // object space input stream
+    std::vector<f32> xs_{};
+    std::vector<f32> ys_{};
+    // matrix index of each block of BLOCK_SIZE vertices
+    std::vector<u32> block_matrices_{};
+    std::vector<math::mat2x3> matrices_{};
+
+    // world space output stream
+    std::vector<f32> world_xs_{};
+    std::vector<f32> world_ys_{};
+
+    std::vector<Object> objects_{};
+};
+
+} // namespace engine::graphics
@@ -0,0 +1,363 @@
+#include "metrics.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iterator>
+
+namespace engine::metrics {
+
+//===========================================================================
+// Histogram
+//===========================================================================
+
+auto Histogram::bucket_index(u64 value) -> u32
+{
+    // the first two power of two ranges map one value per bucket
+    if (value < 2 * SUB_BUCKETS) {
+        return static_cast<u32>(value);
+    }
+    u32 shift = static_cast<u32>(std::bit_width(value)) - 1 - SUB_BUCKET_BITS;
+    return (shift + 1) * SUB_BUCKETS +
+           static_cast<u32>(value >> shift) - SUB_BUCKETS;
+}
+
+auto Histogram::bucket_lowest(u32 index) -> u64
+{
+    if (index < 2 * SUB_BUCKETS) {
+        return index;
+    }
+    u32 shift = index / SUB_BUCKETS - 1;
+    return u64{index % SUB_BUCKETS + SUB_BUCKETS} << shift;
+}
+
+auto Histogram::bucket_highest(u32 index) -> u64
+{
+    if (index < 2 * SUB_BUCKETS) {
+        return index;
+    }
+    u32 shift = index / SUB_BUCKETS - 1;
+    return bucket_lowest(index) + (u64{1} << shift) - 1;
+}
+
+void Histogram::record(u64 value)
+{
+    value = std::min(value, MAX_VALUE);
+    buckets_[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+
+    u64 min = min_.load(std::memory_order_relaxed);
+    while (value < min &&
+           !min_.compare_exchange_weak(min, value, std::memory_order_relaxed)) {
+    }
+    u64 max = max_.load(std::memory_order_relaxed);
+    while (value > max &&
+           !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+}
+
+auto Histogram::summary() const -> HistogramSummary
+{
+    // percentiles are computed from the buckets alone so that they agree
+    // with each other even when values are recorded meanwhile
+    u64 total = 0;
+    for (const auto& bucket : buckets_) {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+    if (total == 0) {
+        return {};
+    }
+
+    u64 max = max_.load(std::memory_order_relaxed);
+    constexpr u64 per_mille[] = {500, 900, 990, 999};
+    u64 percentiles[std::size(per_mille)]{};
+
+    u64 seen = 0;
+    u32 next = 0;
+    for (u32 i = 0; i < BUCKETS && next < std::size(per_mille); ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        while (next < std::size(per_mille) &&
+               seen * 1000 >= total * per_mille[next]) {
+            percentiles[next++] = std::min(bucket_highest(i), max);
+        }
+    }
+
+    u64 count = count_.load(std::memory_order_relaxed);
+    u64 sum = sum_.load(std::memory_order_relaxed);
+    return {
+        count,                                // count
+        min_.load(std::memory_order_relaxed), // min
+        max,                                  // max
+        count > 0 ? sum / count : 0,          // mean
+        percentiles[0],                       // p50
+        percentiles[1],                       // p90
+        percentiles[2],                       // p99
+        percentiles[3],                       // p999
+    };
+}
+
+//===========================================================================
+// MetricsPage
+//===========================================================================
+
+auto read_page(const MetricsPage& page, MetricsPage& copy) -> bool
+{
+    constexpr u32 max_attempts = 1000;
+    for (u32 attempt = 0; attempt < max_attempts; ++attempt) {
+        u32 before = page.sequence.load(std::memory_order_acquire);
+        if ((before & 1) != 0) {
+            continue;
+        }
+
+        copy.magic = page.magic;
+        copy.version = page.version;
+        copy.entry_count = page.entry_count;
+        copy.published_ns = page.published_ns;
+        std::memcpy(copy.entries, page.entries, sizeof(page.entries));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (page.sequence.load(std::memory_order_relaxed) == before) {
+            copy.sequence.store(before, std::memory_order_relaxed);
+            return copy.magic == MetricsPage::MAGIC &&
+                   copy.version == MetricsPage::VERSION &&
+                   copy.entry_count <= MetricsPage::MAX_ENTRIES;
+        }
+    }
+    return false;
+}
+
+//===========================================================================
+// Registry
+//===========================================================================
+
+auto Registry::find(std::string_view name, MetricKind kind) const
+    -> const Entry*
+{
+    for (const auto& entry : entries_) {
+        if (entry.kind == kind && entry.name == name) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+auto Registry::counter(std::string_view name) -> Counter&
+{
+    if (const auto* entry = find(name, MetricKind::COUNTER)) {
+        return counters_[entry->index];
+    }
+    auto index = static_cast<u32>(counters_.size());
+    entries_.push_back({std::string{name}, MetricKind::COUNTER, index});
+    return counters_.emplace_back();
+}
+
+auto Registry::gauge(std::string_view name) -> Gauge&
+{
+    if (const auto* entry = find(name, MetricKind::GAUGE)) {
+        return gauges_[entry->index];
+    }
+    auto index = static_cast<u32>(gauges_.size());
+    entries_.push_back({std::string{name}, MetricKind::GAUGE, index});
+    return gauges_.emplace_back();
+}
+
+auto Registry::histogram(std::string_view name) -> Histogram&
+{
+    if (const auto* entry = find(name, MetricKind::HISTOGRAM)) {
+        return histograms_[entry->index];
+    }
+    auto index = static_cast<u32>(histograms_.size());
+    entries_.push_back({std::string{name}, MetricKind::HISTOGRAM, index});
+    return histograms_.emplace_back();
+}
+
+void Registry::write_json(std::string& out) const
+{
+    // names are plain identifiers and need no escaping
+    out.clear();
+    auto sink = std::back_inserter(out);
+    out += '{';
+    for (u64 i = 0; i < entries_.size(); ++i) {
+        const Entry& entry = entries_[i];
+        std::format_to(sink, "{}\"{}\":", i > 0 ? "," : "", entry.name);
+        switch (entry.kind) {
+            case MetricKind::COUNTER:
+                std::format_to(
+                    sink,
+                    "{{\"type\":\"counter\",\"value\":{}}}",
+                    counters_[entry.index].value()
+                );
+                break;
+            case MetricKind::GAUGE:
+                std::format_to(
+                    sink,
+                    "{{\"type\":\"gauge\",\"value\":{}}}",
+                    gauges_[entry.index].value()
+                );
+                break;
+            case MetricKind::HISTOGRAM: {
+                auto s = histograms_[entry.index].summary();
+                std::format_to(
+                    sink,
+                    "{{\"type\":\"histogram\",\"count\":{},\"min\":{},"
+                    "\"max\":{},\"mean\":{},\"p50\":{},\"p90\":{},"
+                    "\"p99\":{},\"p999\":{}}}",
+                    s.count,
+                    s.min,
+                    s.max,
+                    s.mean,
+                    s.p50,
+                    s.p90,
+                    s.p99,
+                    s.p999
+                );
+                break;
+            }
+        }
+    }
+    out += '}';
+}
+
+void Registry::publish(MetricsPage& page) const
+{
+    u32 sequence = page.sequence.load(std::memory_order_relaxed);
+    page.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    page.magic = MetricsPage::MAGIC;
+    page.version = MetricsPage::VERSION;
+    page.published_ns = time::Instant::now().nanosecond_value();
+
+    u32 count = 0;
+    for (const auto& entry : entries_) {
+        if (count == MetricsPage::MAX_ENTRIES) {
+            break;
+        }
+
+        PageEntry& target = page.entries[count++];
+        target = {};
+        u64 length = std::min(entry.name.size(), sizeof(target.name) - 1);
+        std::memcpy(target.name, entry.name.data(), length);
+        target.kind = entry.kind;
+
+        switch (entry.kind) {
+            case MetricKind::COUNTER:
+                target.value =
+                    static_cast<s64>(counters_[entry.index].value());
+                break;
+            case MetricKind::GAUGE:
+                target.value = gauges_[entry.index].value();
+                break;
+            case MetricKind::HISTOGRAM:
+                target.summary = histograms_[entry.index].summary();
+                target.value = static_cast<s64>(target.summary.count);
+                break;
+        }
+    }
+    page.entry_count = count;
+
+    page.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+//===========================================================================
+// JsonFileWriter
+//===========================================================================
+
+JsonFileWriter::~JsonFileWriter()
+{
+    stop();
+}
+
+auto JsonFileWriter::start(const std::filesystem::path& path) -> bool
+{
+    if (running_) {
+        return false;
+    }
+
+    // fail here rather than silently on the writer thread
+    if (!std::ofstream{path, std::ios::binary | std::ios::trunc}) {
+        return false;
+    }
+    path_ = path;
+
+    for (u32 slot = 0; slot < POOL_SIZE; ++slot) {
+        free_slots_.try_push(slot);
+    }
+
+    running_ = true;
+    writer_ = std::jthread([this](std::stop_token stop_token) {
+        writer_loop(stop_token);
+    });
+
+    return true;
+}
+
+void JsonFileWriter::stop()
+{
+    if (!running_) {
+        return;
+    }
+
+    writer_.request_stop();
+    signal_.fetch_add(1, std::memory_order_release);
+    signal_.notify_one();
+    writer_.join();
+
+    // return the slots so that the writer can be restarted
+    u32 slot{};
+    while (free_slots_.try_pop(slot)) {
+    }
+
+    running_ = false;
+}
+
+auto JsonFileWriter::submit(const Registry& registry) -> bool
+{
+    u32 slot{};
+    if (!running_ || !free_slots_.try_pop(slot)) {
+        return false;
+    }
+
+    // the buffers keep their capacity, so this stops allocating quickly
+    registry.write_json(pool_[slot]);
+
+    // the writer owns the buffers, so a push always succeeds
+    filled_slots_.try_push(slot);
+    signal_.fetch_add(1, std::memory_order_release);
+    signal_.notify_one();
+    return true;
+}
+
+void JsonFileWriter::writer_loop(const std::stop_token& stop_token)
+{
+    while (true) {
+        u32 seen = signal_.load(std::memory_order_acquire);
+
+        u32 slot{};
+        if (filled_slots_.try_pop(slot)) {
+            write_document(slot);
+            continue;
+        }
+
+        // only stop once everything submitted so far has been written
+        if (stop_token.stop_requested()) {
+            break;
+        }
+
+        signal_.wait(seen, std::memory_order_acquire);
+    }
+}
+
+void JsonFileWriter::write_document(u32 slot)
+{
+    const std::string& json = pool_[slot];
+    {
+        std::ofstream file{path_, std::ios::binary | std::ios::trunc};
+        file.write(json.data(), static_cast<std::streamsize>(json.size()));
+    }
+    free_slots_.try_push(slot);
+}
+
+} // namespace engine::metrics
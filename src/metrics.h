@@ -0,0 +1,279 @@
+#pragma once
+
+#include "core.h"
+#include "page_allocator.h"
+#include "spsc_queue.h"
+#include "time.h"
+#include <array>
+#include <atomic>
+#include <deque>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace engine::metrics {
+
+//===========================================================================
+// Counter and Gauge
+//===========================================================================
+
+/** Monotonically increasing count of events. */
+class Counter final {
+public:
+    DEFAULT_CTOR(Counter);
+    DEFAULT_DTOR(Counter);
+    DELETE_COPY(Counter);
+    DELETE_MOVE(Counter);
+
+    void add(u64 amount = 1)
+    {
+        value_.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] auto value() const -> u64
+    {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<u64> value_{0};
+};
+
+/** Last observed value of something that goes up and down. */
+class Gauge final {
+public:
+    DEFAULT_CTOR(Gauge);
+    DEFAULT_DTOR(Gauge);
+    DELETE_COPY(Gauge);
+    DELETE_MOVE(Gauge);
+
+    void set(s64 value) { value_.store(value, std::memory_order_relaxed); }
+
+    [[nodiscard]] auto value() const -> s64
+    {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<s64> value_{0};
+};
+
+//===========================================================================
+// Histogram
+//===========================================================================
+
+struct HistogramSummary {
+    u64 count;
+    u64 min;
+    u64 max;
+    u64 mean;
+    u64 p50;
+    u64 p90;
+    u64 p99;
+    u64 p999;
+};
+
+/**
+ * High dynamic range histogram of non-negative values (typically
+ * nanoseconds).
+ *
+ * Buckets are log-linear: every power of two range is split into 32 equal
+ * sub-buckets, which keeps the relative error of any reported value below
+ * about 3% from one nanosecond up to 2^40 (18 minutes) with a fixed 9 KB of
+ * counters. Recording is a few relaxed atomic increments, so any thread can
+ * record without locks.
+ */
+class Histogram final {
+public:
+    static constexpr u32 SUB_BUCKET_BITS = 5;
+    static constexpr u32 SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr u32 VALUE_BITS = 40;
+    static constexpr u64 MAX_VALUE = (u64{1} << VALUE_BITS) - 1;
+    static constexpr u32 BUCKETS = (VALUE_BITS - SUB_BUCKET_BITS + 1) *
+                                   SUB_BUCKETS;
+
+    DEFAULT_CTOR(Histogram);
+    DEFAULT_DTOR(Histogram);
+    DELETE_COPY(Histogram);
+    DELETE_MOVE(Histogram);
+
+    /** Values above MAX_VALUE are recorded as MAX_VALUE. */
+    void record(u64 value);
+
+    void record(time::Duration duration)
+    {
+        record(duration.nanosecond_value());
+    }
+
+    /**
+     * Percentiles report the upper end of their bucket. Values recorded
+     * concurrently may or may not be included.
+     */
+    [[nodiscard]] auto summary() const -> HistogramSummary;
+
+    static auto bucket_index(u64 value) -> u32;
+    static auto bucket_lowest(u32 index) -> u64;
+    static auto bucket_highest(u32 index) -> u64;
+
+private:
+    std::atomic<u64> count_{0};
+    std::atomic<u64> sum_{0};
+    std::atomic<u64> min_{~u64{0}};
+    std::atomic<u64> max_{0};
+    std::array<std::atomic<u64>, BUCKETS> buckets_{};
+};
+
+//===========================================================================
+// MetricsPage
+//===========================================================================
+
+enum MetricKind : u32 {
+    COUNTER,
+    GAUGE,
+    HISTOGRAM,
+};
+
+struct PageEntry {
+    char name[32];
+    MetricKind kind;
+    u32 reserved;
+    /** Counter or gauge value; histogram count. */
+    s64 value;
+    /** Histogram summary; zero for counters and gauges. */
+    HistogramSummary summary;
+};
+
+/**
+ * Fixed layout snapshot of all metrics meant for a shared memory page that
+ * external monitors map read-only.
+ *
+ * The writer bumps `sequence` to an odd value before and back to an even
+ * value after updating the entries; readers copy the page and retry if the
+ * sequence was odd or changed meanwhile (see read_page()).
+ */
+struct MetricsPage {
+    static constexpr u32 MAGIC = 0x4d455452; // "METR"
+    static constexpr u32 VERSION = 1;
+    static constexpr u32 MAX_ENTRIES = 32;
+
+    u32 magic;
+    u32 version;
+    std::atomic<u32> sequence;
+    u32 entry_count;
+    /** Instant of the last publish in nanoseconds. */
+    u64 published_ns;
+    PageEntry entries[MAX_ENTRIES];
+};
+
+static_assert(
+    sizeof(MetricsPage) <= memory::STANDARD_PAGE_SIZE,
+    "MetricsPage must fit a single page"
+);
+
+/**
+ * Copies a consistent snapshot of a page another process is publishing.
+ * Returns false if the writer kept it busy for too long or the page is not
+ * (yet) a metrics page.
+ */
+auto read_page(const MetricsPage& page, MetricsPage& copy) -> bool;
+
+//===========================================================================
+// Registry
+//===========================================================================
+
+/**
+ * Named metrics of the process.
+ *
+ * Metrics are registered up front, typically at startup on one thread, and
+ * live as long as the registry; the returned references are then safe to
+ * record into from any thread. Registering an existing name returns the
+ * existing metric.
+ */
+class Registry final {
+public:
+    DEFAULT_CTOR(Registry);
+    DEFAULT_DTOR(Registry);
+    DELETE_COPY(Registry);
+    DELETE_MOVE(Registry);
+
+    auto counter(std::string_view name) -> Counter&;
+    auto gauge(std::string_view name) -> Gauge&;
+    auto histogram(std::string_view name) -> Histogram&;
+
+    /** Replaces `out` with all metrics as one JSON object. */
+    void write_json(std::string& out) const;
+
+    /** Writes all metrics (up to the page capacity) into `page`. */
+    void publish(MetricsPage& page) const;
+
+private:
+    struct Entry {
+        std::string name;
+        MetricKind kind;
+        u32 index;
+    };
+
+    auto find(std::string_view name, MetricKind kind) const -> const Entry*;
+
+    std::vector<Entry> entries_{};
+    std::deque<Counter> counters_{};
+    std::deque<Gauge> gauges_{};
+    std::deque<Histogram> histograms_{};
+};
+
+//===========================================================================
+// JsonFileWriter
+//===========================================================================
+
+/**
+ * Keeps a file rewritten with the JSON of a registry, on a background
+ * thread.
+ *
+ * The game thread only formats the JSON into one of a few reused buffers
+ * and hands it over; opening, truncating and writing the file happen on
+ * the writer thread. When the writer still holds every buffer the export
+ * is skipped, the next one carries newer values anyway.
+ */
+class JsonFileWriter final {
+public:
+    DEFAULT_CTOR(JsonFileWriter);
+    DELETE_COPY(JsonFileWriter);
+    DELETE_MOVE(JsonFileWriter);
+
+    ~JsonFileWriter();
+
+    /** Number of documents that can be in flight at once. */
+    static constexpr u32 POOL_SIZE = 2;
+
+    /** Checks that `path` can be written and starts the writer thread. */
+    auto start(const std::filesystem::path& path) -> bool;
+
+    /** Writes the queued documents and stops the writer thread. */
+    void stop();
+
+    /**
+     * Formats the registry into a free buffer and hands it to the writer
+     * thread. Returns false when the export had to be skipped.
+     */
+    auto submit(const Registry& registry) -> bool;
+
+    [[nodiscard]] auto is_running() const -> bool { return running_; }
+
+private:
+    void writer_loop(const std::stop_token& stop_token);
+    void write_document(u32 slot);
+
+    bool running_{false};
+    std::filesystem::path path_{};
+
+    std::array<std::string, POOL_SIZE> pool_{};
+    sync::SpscQueue<u32, POOL_SIZE> free_slots_{};
+    sync::SpscQueue<u32, POOL_SIZE> filled_slots_{};
+    std::atomic<u32> signal_{0};
+
+    std::jthread writer_{};
+};
+
+} // namespace engine::metrics
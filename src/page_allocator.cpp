@@ -0,0 +1,206 @@
+#include "page_allocator.h"
+#include <cstring>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace engine::memory {
+
+#if defined(_MSC_FULL_VER)
+
+namespace {
+
+/**
+ * Large pages need SeLockMemoryPrivilege, which is disabled in the token
+ * even when the account holds it. Returns false if it is not held.
+ */
+auto enable_lock_memory_privilege() -> bool
+{
+    HANDLE token{};
+    if (!OpenProcessToken(
+            GetCurrentProcess(),
+            TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY,
+            &token
+        )) {
+        return false;
+    }
+
+    TOKEN_PRIVILEGES privileges{};
+    privileges.PrivilegeCount = 1;
+    privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+    bool enabled =
+        LookupPrivilegeValue(
+            nullptr,
+            SE_LOCK_MEMORY_NAME,
+            &privileges.Privileges[0].Luid
+        ) &&
+        AdjustTokenPrivileges(
+            token,
+            FALSE,
+            &privileges,
+            0,
+            nullptr,
+            nullptr
+        ) &&
+        // succeeds with ERROR_NOT_ALL_ASSIGNED when the privilege is not held
+        GetLastError() == ERROR_SUCCESS;
+
+    CloseHandle(token);
+    return enabled;
+}
+
+} // namespace
+
+auto allocate_pages(u64 size, PagePolicy policy) -> PageAllocation
+{
+    // Windows has no transparent huge pages; large pages are tried only when
+    // explicitly asked for and the account holds SeLockMemoryPrivilege
+    static const bool large_pages_allowed = enable_lock_memory_privilege();
+    if (policy == PagePolicy::EXPLICIT_HUGE_PAGES && large_pages_allowed) {
+        u64 large_page_size = GetLargePageMinimum();
+        if (large_page_size > 0) {
+            u64 large_size = align_up(size, large_page_size);
+            void* data = VirtualAlloc(
+                nullptr,
+                large_size,
+                MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                PAGE_READWRITE
+            );
+            if (data != nullptr) {
+                return {data, large_size, PagePolicy::EXPLICIT_HUGE_PAGES};
+            }
+        }
+    }
+
+    u64 aligned_size = align_up(size, STANDARD_PAGE_SIZE);
+    void* data = VirtualAlloc(
+        nullptr,
+        aligned_size,
+        MEM_RESERVE | MEM_COMMIT,
+        PAGE_READWRITE
+    );
+    if (data == nullptr) {
+        PANICM("out of memory");
+    }
+    return {data, aligned_size, PagePolicy::STANDARD_PAGES};
+}
+
+void release_pages(PageAllocation& allocation)
+{
+    if (allocation.data != nullptr) {
+        VirtualFree(allocation.data, 0, MEM_RELEASE);
+    }
+    allocation = {};
+}
+
+#elif defined(__linux__)
+
+namespace {
+
+/**
+ * Maps anonymous memory aligned to `alignment` by over-allocating and
+ * trimming the unaligned head and tail.
+ */
+auto map_aligned(u64 size, u64 alignment) -> void*
+{
+    u64 mapped_size = size + alignment;
+    void* mapping = mmap(
+        nullptr,
+        mapped_size,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0
+    );
+    if (mapping == MAP_FAILED) {
+        return nullptr;
+    }
+
+    auto begin = reinterpret_cast<u64>(mapping);
+    u64 aligned = align_up(begin, alignment);
+    u64 head = aligned - begin;
+    u64 tail = mapped_size - head - size;
+    if (head > 0) {
+        munmap(mapping, head);
+    }
+    if (tail > 0) {
+        munmap(reinterpret_cast<void*>(aligned + size), tail);
+    }
+    return reinterpret_cast<void*>(aligned);
+}
+
+} // namespace
+
+auto allocate_pages(u64 size, PagePolicy policy) -> PageAllocation
+{
+    if (policy == PagePolicy::EXPLICIT_HUGE_PAGES) {
+        u64 huge_size = align_up(size, HUGE_PAGE_SIZE);
+        void* data = mmap(
+            nullptr,
+            huge_size,
+            PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+            -1,
+            0
+        );
+        if (data != MAP_FAILED) {
+            return {data, huge_size, PagePolicy::EXPLICIT_HUGE_PAGES};
+        }
+        // hugetlbfs pool is empty or not configured; try THP instead
+        policy = PagePolicy::TRANSPARENT_HUGE_PAGES;
+    }
+
+    if (policy == PagePolicy::TRANSPARENT_HUGE_PAGES) {
+        // THP can only back huge page aligned ranges
+        u64 huge_size = align_up(size, HUGE_PAGE_SIZE);
+        void* data = map_aligned(huge_size, HUGE_PAGE_SIZE);
+        if (data != nullptr) {
+            if (madvise(data, huge_size, MADV_HUGEPAGE) == 0) {
+                return {data, huge_size, PagePolicy::TRANSPARENT_HUGE_PAGES};
+            }
+            return {data, huge_size, PagePolicy::STANDARD_PAGES};
+        }
+    }
+
+    u64 aligned_size = align_up(size, STANDARD_PAGE_SIZE);
+    void* data = map_aligned(aligned_size, STANDARD_PAGE_SIZE);
+    if (data == nullptr) {
+        PANICM("out of memory");
+    }
+    return {data, aligned_size, PagePolicy::STANDARD_PAGES};
+}
+
+void release_pages(PageAllocation& allocation)
+{
+    if (allocation.data != nullptr) {
+        munmap(allocation.data, allocation.size);
+    }
+    allocation = {};
+}
+
+#else
+
+auto allocate_pages(u64 size, [[maybe_unused]] PagePolicy policy)
+    -> PageAllocation
+{
+    u64 aligned_size = align_up(size, STANDARD_PAGE_SIZE);
+    auto alignment = std::align_val_t{STANDARD_PAGE_SIZE};
+    void* data = ::operator new(aligned_size, alignment);
+    std::memset(data, 0, aligned_size);
+    return {data, aligned_size, PagePolicy::STANDARD_PAGES};
+}
+
+void release_pages(PageAllocation& allocation)
+{
+    if (allocation.data != nullptr) {
+        auto alignment = std::align_val_t{STANDARD_PAGE_SIZE};
+        ::operator delete(allocation.data, alignment);
+    }
+    allocation = {};
+}
+
+#endif
+
+} // namespace engine::memory
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "core.h"
+
+namespace engine::memory {
+
+/** Minimum alignment of every page allocation. */
+constexpr u64 STANDARD_PAGE_SIZE = 4096;
+
+/** Size of a huge page on the platforms we care about (x86-64). */
+constexpr u64 HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+enum PagePolicy {
+    /** Regular pages. */
+    STANDARD_PAGES,
+    /** Regular pages, hinted to be backed by transparent huge pages. */
+    TRANSPARENT_HUGE_PAGES,
+    /** Explicitly reserved huge pages (hugetlbfs / large page privilege). */
+    EXPLICIT_HUGE_PAGES,
+};
+
+/**
+ * Block of page aligned, zero-initialized memory obtained directly from the
+ * operating system. The pages are zeroed lazily by the OS on first touch.
+ */
+struct PageAllocation {
+    void* data;
+    /** Usable size; rounded up to the page size of the allocation. */
+    u64 size;
+    /** Policy the allocation actually got; may differ from the request. */
+    PagePolicy policy;
+};
+
+/**
+ * Allocates at least `size` bytes of page aligned memory. Huge page requests
+ * silently fall back to standard pages when the system cannot satisfy them.
+ * Panics if no memory could be allocated.
+ */
+auto allocate_pages(
+    u64 size,
+    PagePolicy policy = PagePolicy::STANDARD_PAGES
+) -> PageAllocation;
+
+void release_pages(PageAllocation& allocation);
+
+constexpr auto align_up(u64 value, u64 alignment) -> u64
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace engine::memory
@@ -0,0 +1,274 @@
+#pragma once
+
+#include "core.h"
+#include "dirty_regions.h"
+#include "graphics.h"
+#include "world.h"
+#include <algorithm>
+
+namespace engine::particles {
+
+/**
+ * Description of a single particle; also the element type of AosLayout.
+ */
+struct Particle {
+    s32 x;
+    s32 y;
+    s32 velocity_x;
+    s32 velocity_y;
+    graphics::ARGB color;
+};
+
+//===========================================================================
+// Boundary policies
+//===========================================================================
+//
+// A boundary policy decides what happens to a particle that left the area
+// [0, size) on one axis. apply() must be branch-free so that the update loop
+// vectorizes; policies that remove particles do so in a separate compaction
+// pass based on inside().
+//
+
+/** Particles leaving one edge re-enter from the opposite edge. */
+struct WrapBoundary {
+    static constexpr bool KILLS = false;
+
+    static void apply(s32& position, [[maybe_unused]] s32& velocity, s32 size)
+    {
+        // velocities are always smaller than the area, so one correction
+        // in either direction is enough
+        position = world::wrap_near(position, size);
+    }
+};
+
+/** Particles are reflected back from the edges. */
+struct BounceBoundary {
+    static constexpr bool KILLS = false;
+
+    static void apply(s32& position, s32& velocity, s32 size)
+    {
+        s32 outside = static_cast<s32>(position < 0) |
+                      static_cast<s32>(position >= size);
+        position = std::clamp(position, 0, size - 1);
+        velocity *= 1 - 2 * outside;
+    }
+};
+
+/** Particles leaving the area are removed. */
+struct KillBoundary {
+    static constexpr bool KILLS = true;
+
+    static void apply(
+        [[maybe_unused]] s32& position,
+        [[maybe_unused]] s32& velocity,
+        [[maybe_unused]] s32 size
+    )
+    {
+    }
+
+    static auto inside(s32 position, s32 size) -> bool
+    {
+        return static_cast<u32>(position) < static_cast<u32>(size);
+    }
+};
+
+//===========================================================================
+// Blend policies
+//===========================================================================
+
+/** Particle color replaces the pixel. */
+struct OpaqueBlend {
+    static auto
+    blend([[maybe_unused]] graphics::ARGB target, graphics::ARGB source)
+        -> graphics::ARGB
+    {
+        return source;
+    }
+};
+
+/** Particle color is added to the pixel, saturating each channel. */
+struct AdditiveBlend {
+    static auto blend(graphics::ARGB target, graphics::ARGB source)
+        -> graphics::ARGB
+    {
+        // SWAR saturating add of four 8-bit channels
+        u32 a = target.value;
+        u32 b = source.value;
+        u32 sum = (a & 0x7f7f7f7f) + (b & 0x7f7f7f7f);
+        sum ^= (a ^ b) & 0x80808080;
+        u32 overflow = ((a & b) | ((a | b) & ~sum)) & 0x80808080;
+        graphics::ARGB result{};
+        result.value = sum | ((overflow >> 7) * 0xff);
+        return result;
+    }
+};
+
+//===========================================================================
+// Layouts
+//===========================================================================
+
+/** Structure of arrays; the update loop vectorizes over each component. */
+struct SoaLayout {
+    template <u32 Capacity>
+    struct Storage {
+        s32 xs[Capacity];
+        s32 ys[Capacity];
+        s32 velocity_xs[Capacity];
+        s32 velocity_ys[Capacity];
+        graphics::ARGB colors[Capacity];
+
+        auto x(u32 i) -> s32& { return xs[i]; }
+        auto y(u32 i) -> s32& { return ys[i]; }
+        auto velocity_x(u32 i) -> s32& { return velocity_xs[i]; }
+        auto velocity_y(u32 i) -> s32& { return velocity_ys[i]; }
+        auto color(u32 i) -> graphics::ARGB& { return colors[i]; }
+
+        [[nodiscard]] auto get(u32 i) const -> Particle
+        {
+            return {xs[i], ys[i], velocity_xs[i], velocity_ys[i], colors[i]};
+        }
+
+        void set(u32 i, const Particle& particle)
+        {
+            xs[i] = particle.x;
+            ys[i] = particle.y;
+            velocity_xs[i] = particle.velocity_x;
+            velocity_ys[i] = particle.velocity_y;
+            colors[i] = particle.color;
+        }
+    };
+};
+
+/** Array of structures; keeps each particle on a single cache line. */
+struct AosLayout {
+    template <u32 Capacity>
+    struct Storage {
+        Particle particles[Capacity];
+
+        auto x(u32 i) -> s32& { return particles[i].x; }
+        auto y(u32 i) -> s32& { return particles[i].y; }
+        auto velocity_x(u32 i) -> s32& { return particles[i].velocity_x; }
+        auto velocity_y(u32 i) -> s32& { return particles[i].velocity_y; }
+        auto color(u32 i) -> graphics::ARGB& { return particles[i].color; }
+
+        [[nodiscard]] auto get(u32 i) const -> Particle
+        {
+            return particles[i];
+        }
+
+        void set(u32 i, const Particle& particle) { particles[i] = particle; }
+    };
+};
+
+//===========================================================================
+// ParticleSystem
+//===========================================================================
+
+/**
+ * Fixed capacity particle system. Everything that differs between effects
+ * is a compile-time policy, so each configuration gets its own fully inlined
+ * update and draw loop without any runtime switches.
+ */
+template <
+    u32 Capacity,
+    typename BoundaryPolicy,
+    typename BlendPolicy = OpaqueBlend,
+    typename Layout = SoaLayout>
+class ParticleSystem final {
+public:
+    DEFAULT_CTOR(ParticleSystem);
+    DEFAULT_DTOR(ParticleSystem);
+    DEFAULT_COPY(ParticleSystem);
+    DEFAULT_MOVE(ParticleSystem);
+
+    static constexpr u32 CAPACITY = Capacity;
+
+    void clear() { count_ = 0; }
+
+    /** Drops every particle past the first `count`. */
+    void truncate(u32 count) { count_ = std::min(count_, count); }
+
+    /** Adds a particle; returns false if the system is full. */
+    auto spawn(const Particle& particle) -> bool
+    {
+        if (count_ == Capacity) {
+            return false;
+        }
+        storage_.set(count_++, particle);
+        return true;
+    }
+
+    /**
+     * Moves every particle by its velocity and applies the boundary policy
+     * against the area [0, width) x [0, height).
+     */
+    void update(s32 width, s32 height)
+    {
+        for (u32 i = 0; i < count_; ++i) {
+            storage_.x(i) += storage_.velocity_x(i);
+            storage_.y(i) += storage_.velocity_y(i);
+            BoundaryPolicy::apply(
+                storage_.x(i),
+                storage_.velocity_x(i),
+                width
+            );
+            BoundaryPolicy::apply(
+                storage_.y(i),
+                storage_.velocity_y(i),
+                height
+            );
+        }
+
+        if constexpr (BoundaryPolicy::KILLS) {
+            // branch-free stable compaction; every particle is copied and the
+            // write cursor only advances past the survivors
+            u32 alive = 0;
+            for (u32 i = 0; i < count_; ++i) {
+                Particle particle = storage_.get(i);
+                storage_.set(alive, particle);
+                alive += static_cast<u32>(
+                    BoundaryPolicy::inside(particle.x, width) &
+                    BoundaryPolicy::inside(particle.y, height)
+                );
+            }
+            count_ = alive;
+        }
+    }
+
+    /**
+     * Draws the particles; a non-zero `shift` draws into a buffer that is
+     * 2^shift times smaller than the area the particles move in. The
+     * written pixels are marked in `dirty` if given.
+     */
+    void draw(
+        graphics::ScreenBuffer& screen_buffer,
+        u32 shift = 0,
+        graphics::DirtyRegions* dirty = nullptr
+    )
+    {
+        auto width = static_cast<u32>(screen_buffer.width);
+        auto height = static_cast<u32>(screen_buffer.height);
+
+        for (u32 i = 0; i < count_; ++i) {
+            auto x = static_cast<u32>(storage_.x(i)) >> shift;
+            auto y = static_cast<u32>(storage_.y(i)) >> shift;
+            // only fails if the buffer shrank since the last update
+            if ((x < width) & (y < height)) {
+                u64 index = static_cast<u64>(y) * width + x;
+                auto& pixel = screen_buffer.pixels[index];
+                pixel = BlendPolicy::blend(pixel, storage_.color(i));
+                if (dirty != nullptr) {
+                    dirty->mark_pixel(index);
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] auto count() const -> u32 { return count_; }
+
+private:
+    typename Layout::template Storage<Capacity> storage_{};
+    u32 count_{0};
+};
+
+} // namespace engine::particles
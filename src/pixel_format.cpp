@@ -0,0 +1,322 @@
+#include "pixel_format.h"
+#include "simd.h"
+#include <cstring>
+
+namespace engine::graphics {
+
+namespace {
+
+using RowConverter = void (*)(const ARGB* source, u8* target, s32 width);
+
+//===========================================================================
+// Reference (per-pixel) conversions
+//===========================================================================
+
+constexpr auto gray(ARGB pixel) -> u8
+{
+    const auto& c = pixel.colors;
+    s32 sum = 77 * c.red + 150 * c.green + 29 * c.blue + 128;
+    return static_cast<u8>(sum >> 8);
+}
+
+constexpr auto rgb565(ARGB pixel) -> u16
+{
+    const auto& c = pixel.colors;
+    return static_cast<u16>(
+        ((c.red >> 3) << 11) | ((c.green >> 2) << 5) | (c.blue >> 3)
+    );
+}
+
+void convert_pixel_reference(ARGB pixel, u8* target, PixelFormat format)
+{
+    const auto& c = pixel.colors;
+    switch (format) {
+        case PixelFormat::BGRA32:
+            std::memcpy(target, &pixel, 4);
+            break;
+        case PixelFormat::RGBA32:
+            target[0] = c.red;
+            target[1] = c.green;
+            target[2] = c.blue;
+            target[3] = c.alpha;
+            break;
+        case PixelFormat::BGR24:
+            target[0] = c.blue;
+            target[1] = c.green;
+            target[2] = c.red;
+            break;
+        case PixelFormat::RGB24:
+            target[0] = c.red;
+            target[1] = c.green;
+            target[2] = c.blue;
+            break;
+        case PixelFormat::RGB565: {
+            u16 value = rgb565(pixel);
+            std::memcpy(target, &value, 2);
+            break;
+        }
+        case PixelFormat::GRAY8:
+            target[0] = gray(pixel);
+            break;
+    }
+}
+
+//===========================================================================
+// Row kernels
+//===========================================================================
+//
+// Every kernel converts as much of the row as possible with SIMD (or SWAR
+// when SIMD is not available) and finishes the remainder per pixel. The
+// stores never run ahead of the loads, which is what makes in place
+// conversion safe.
+//
+
+void row_bgra32(const ARGB* source, u8* target, s32 width)
+{
+    // memmove since the conversion may be in place
+    std::memmove(target, source, static_cast<u64>(width) * sizeof(ARGB));
+}
+
+void row_rgba32(const ARGB* source, u8* target, s32 width)
+{
+    s32 x = 0;
+
+#if defined(ENGINE_SIMD_SSSE3)
+    const __m128i swap = _mm_setr_epi8(
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15
+    );
+    for (; x + 4 <= width; x += 4) {
+        __m128i pixels =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x));
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(target + x * 4),
+            _mm_shuffle_epi8(pixels, swap)
+        );
+    }
+#elif defined(ENGINE_SIMD_SSE2)
+    const __m128i keep = _mm_set1_epi32(static_cast<s32>(0xff00ff00));
+    const __m128i low = _mm_set1_epi32(0xff);
+    for (; x + 4 <= width; x += 4) {
+        __m128i pixels =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x));
+        __m128i swapped = _mm_or_si128(
+            _mm_and_si128(pixels, keep),
+            _mm_or_si128(
+                _mm_and_si128(_mm_srli_epi32(pixels, 16), low),
+                _mm_slli_epi32(_mm_and_si128(pixels, low), 16)
+            )
+        );
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(target + x * 4), swapped);
+    }
+#endif
+
+    for (; x < width; ++x) {
+        convert_pixel_reference(source[x], target + x * 4, PixelFormat::RGBA32);
+    }
+}
+
+/**
+ * Packs 24-bit pixels four at a time.
+ */
+template <PixelFormat Format>
+void row_24(const ARGB* source, u8* target, s32 width)
+{
+    static_assert(Format == PixelFormat::BGR24 || Format == PixelFormat::RGB24);
+    s32 x = 0;
+
+#if defined(ENGINE_SIMD_SSSE3)
+    // each iteration stores 16 bytes of which the last 4 are overwritten by
+    // the next iteration; stop early enough to stay inside the row
+    // clang-format off
+    const __m128i shuffle = Format == PixelFormat::BGR24 ?
+        _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1) :
+        _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    // clang-format on
+    for (; x + 6 <= width; x += 4) {
+        __m128i pixels =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x));
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(target + x * 3),
+            _mm_shuffle_epi8(pixels, shuffle)
+        );
+    }
+#else
+    // SWAR; four pixels become three 32-bit words
+    for (; x + 4 <= width; x += 4) {
+        u32 p[4];
+        std::memcpy(p, source + x, sizeof(p));
+        if constexpr (Format == PixelFormat::RGB24) {
+            for (u32& value : p) {
+                value = (value & 0x0000ff00) | ((value >> 16) & 0xff) |
+                        ((value & 0xff) << 16);
+            }
+        }
+        u32 words[3] = {
+            (p[0] & 0x00ffffff) | (p[1] << 24),
+            ((p[1] >> 8) & 0x0000ffff) | (p[2] << 16),
+            ((p[2] >> 16) & 0x000000ff) | (p[3] << 8),
+        };
+        std::memcpy(target + x * 3, words, sizeof(words));
+    }
+#endif
+
+    for (; x < width; ++x) {
+        convert_pixel_reference(source[x], target + x * 3, Format);
+    }
+}
+
+void row_rgb565(const ARGB* source, u8* target, s32 width)
+{
+    s32 x = 0;
+
+#if defined(ENGINE_SIMD_SSE2)
+    const __m128i red = _mm_set1_epi32(0xf800);
+    const __m128i green = _mm_set1_epi32(0x07e0);
+    const __m128i blue = _mm_set1_epi32(0x001f);
+    auto pack = [&](__m128i pixels) {
+        __m128i value = _mm_or_si128(
+            _mm_or_si128(
+                _mm_and_si128(_mm_srli_epi32(pixels, 8), red),
+                _mm_and_si128(_mm_srli_epi32(pixels, 5), green)
+            ),
+            _mm_and_si128(_mm_srli_epi32(pixels, 3), blue)
+        );
+        // sign extend so that the signed saturating pack keeps all 16 bits
+        return _mm_srai_epi32(_mm_slli_epi32(value, 16), 16);
+    };
+
+    for (; x + 8 <= width; x += 8) {
+        const auto* in = reinterpret_cast<const __m128i*>(source + x);
+        __m128i lo = pack(_mm_loadu_si128(in));
+        __m128i hi = pack(_mm_loadu_si128(in + 1));
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(target + x * 2),
+            _mm_packs_epi32(lo, hi)
+        );
+    }
+#endif
+
+    for (; x < width; ++x) {
+        convert_pixel_reference(source[x], target + x * 2, PixelFormat::RGB565);
+    }
+}
+
+void row_gray8(const ARGB* source, u8* target, s32 width)
+{
+    s32 x = 0;
+
+#if defined(ENGINE_SIMD_SSE2)
+    const __m128i mask = _mm_set1_epi32(0xff);
+    auto channel = [&](__m128i lo, __m128i hi, int shift) {
+        return _mm_packs_epi32(
+            _mm_and_si128(_mm_srli_epi32(lo, shift), mask),
+            _mm_and_si128(_mm_srli_epi32(hi, shift), mask)
+        );
+    };
+
+    for (; x + 8 <= width; x += 8) {
+        const auto* in = reinterpret_cast<const __m128i*>(source + x);
+        __m128i lo = _mm_loadu_si128(in);
+        __m128i hi = _mm_loadu_si128(in + 1);
+
+        // the weighted sum of 8-bit channels fits into unsigned 16 bits
+        __m128i sum = _mm_add_epi16(
+            _mm_add_epi16(
+                _mm_mullo_epi16(channel(lo, hi, 16), _mm_set1_epi16(77)),
+                _mm_mullo_epi16(channel(lo, hi, 8), _mm_set1_epi16(150))
+            ),
+            _mm_add_epi16(
+                _mm_mullo_epi16(channel(lo, hi, 0), _mm_set1_epi16(29)),
+                _mm_set1_epi16(128)
+            )
+        );
+        __m128i luma = _mm_srli_epi16(sum, 8);
+        _mm_storel_epi64(
+            reinterpret_cast<__m128i*>(target + x),
+            _mm_packus_epi16(luma, luma)
+        );
+    }
+#endif
+
+    for (; x < width; ++x) {
+        target[x] = gray(source[x]);
+    }
+}
+
+auto row_converter(PixelFormat format) -> RowConverter
+{
+    switch (format) {
+        case PixelFormat::BGRA32:
+            return row_bgra32;
+        case PixelFormat::RGBA32:
+            return row_rgba32;
+        case PixelFormat::BGR24:
+            return row_24<PixelFormat::BGR24>;
+        case PixelFormat::RGB24:
+            return row_24<PixelFormat::RGB24>;
+        case PixelFormat::RGB565:
+            return row_rgb565;
+        case PixelFormat::GRAY8:
+            return row_gray8;
+    }
+    UNREACHABLE();
+}
+
+} // namespace
+
+void convert_pixels(
+    const ARGB* source,
+    s64 source_stride,
+    void* target,
+    s64 target_stride,
+    PixelFormat format,
+    s32 width,
+    s32 height
+)
+{
+    // resolve the kernel once, not per row
+    RowConverter convert_row = row_converter(format);
+
+    const auto* source_row = reinterpret_cast<const u8*>(source);
+    auto* target_row = static_cast<u8*>(target);
+    for (s32 y = 0; y < height; ++y) {
+        convert_row(
+            reinterpret_cast<const ARGB*>(source_row),
+            target_row,
+            width
+        );
+        source_row += source_stride;
+        target_row += target_stride;
+    }
+}
+
+void convert_pixels_reference(
+    const ARGB* source,
+    s64 source_stride,
+    void* target,
+    s64 target_stride,
+    PixelFormat format,
+    s32 width,
+    s32 height
+)
+{
+    u32 target_bytes = bytes_per_pixel(format);
+
+    const auto* source_row = reinterpret_cast<const u8*>(source);
+    auto* target_row = static_cast<u8*>(target);
+    for (s32 y = 0; y < height; ++y) {
+        for (s32 x = 0; x < width; ++x) {
+            ARGB pixel{};
+            std::memcpy(&pixel, source_row + x * 4, sizeof(pixel));
+            convert_pixel_reference(
+                pixel,
+                target_row + static_cast<u32>(x) * target_bytes,
+                format
+            );
+        }
+        source_row += source_stride;
+        target_row += target_stride;
+    }
+}
+
+} // namespace engine::graphics
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "core.h"
+#include "graphics.h"
+
+namespace engine::graphics {
+
+/**
+ * Pixel formats an output backend may ask for. Multi-byte formats are named
+ * after their byte order in memory; RGB565 is a little-endian 16-bit word.
+ */
+enum PixelFormat {
+    /** Native ScreenBuffer format; B, G, R, A bytes. */
+    BGRA32,
+    RGBA32,
+    BGR24,
+    RGB24,
+    RGB565,
+    /** BT.601 full range luma. */
+    GRAY8,
+};
+
+constexpr auto bytes_per_pixel(PixelFormat format) -> u32
+{
+    switch (format) {
+        case PixelFormat::BGRA32:
+        case PixelFormat::RGBA32:
+            return 4;
+        case PixelFormat::BGR24:
+        case PixelFormat::RGB24:
+            return 3;
+        case PixelFormat::RGB565:
+            return 2;
+        case PixelFormat::GRAY8:
+            return 1;
+    }
+    UNREACHABLE();
+}
+
+/**
+ * Converts native BGRA32 pixels into the given format. Strides are in bytes
+ * and may include padding.
+ *
+ * The conversion may be done in place (target == source) since no target
+ * format is wider than the source, as long as target_stride does not exceed
+ * source_stride. The alpha channel is passed through as is.
+ */
+void convert_pixels(
+    const ARGB* source,
+    s64 source_stride,
+    void* target,
+    s64 target_stride,
+    PixelFormat format,
+    s32 width,
+    s32 height
+);
+
+/**
+ * Straightforward per-pixel implementation of convert_pixels(); the
+ * reference the vectorized kernels are validated against. Not meant to be
+ * used on any hot path.
+ */
+void convert_pixels_reference(
+    const ARGB* source,
+    s64 source_stride,
+    void* target,
+    s64 target_stride,
+    PixelFormat format,
+    s32 width,
+    s32 height
+);
+
+} // namespace engine::graphics
@@ -0,0 +1,61 @@
+#include "quality_governor.h"
+#include <algorithm>
+
+namespace engine::quality {
+
+QualityGovernor::QualityGovernor(
+    const GovernorConfig& config,
+    u32 initial_level
+) :
+    config_(config),
+    level_(std::min(initial_level, config.levels - 1)),
+    required_calm_windows_(config.upgrade_windows)
+{
+}
+
+auto QualityGovernor::observe(time::Duration work) -> bool
+{
+    window_ns_ += work.nanosecond_value();
+    if (++window_ticks_ < config_.window_ticks) {
+        return false;
+    }
+
+    auto mean = static_cast<f32>(window_ns_ / window_ticks_);
+    load_ = mean / static_cast<f32>(config_.frame_budget.nanosecond_value());
+    window_ns_ = 0;
+    window_ticks_ = 0;
+    windows_since_upgrade_ =
+        std::min(windows_since_upgrade_ + 1, MAX_UPGRADE_WINDOWS);
+
+    if (load_ > config_.downgrade_load) {
+        calm_windows_ = 0;
+        if (level_ == 0) {
+            return false;
+        }
+        if (windows_since_upgrade_ <= config_.upgrade_windows) {
+            // the level above is too expensive; wait longer next time
+            required_calm_windows_ =
+                std::min(required_calm_windows_ * 2, MAX_UPGRADE_WINDOWS);
+        }
+        --level_;
+        ++downgrades_;
+        return true;
+    }
+
+    if (load_ >= config_.upgrade_load) {
+        calm_windows_ = 0;
+        return false;
+    }
+
+    if (++calm_windows_ < required_calm_windows_ ||
+        level_ + 1 == config_.levels) {
+        return false;
+    }
+    calm_windows_ = 0;
+    ++level_;
+    ++upgrades_;
+    windows_since_upgrade_ = 0;
+    return true;
+}
+
+} // namespace engine::quality
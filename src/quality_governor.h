@@ -0,0 +1,65 @@
+#pragma once
+
+#include "core.h"
+#include "time.h"
+
+namespace engine::quality {
+
+struct GovernorConfig {
+    /** Time a tick may spend on update and render. */
+    time::Duration frame_budget;
+    /** Number of quality levels; level 0 is the cheapest. */
+    u32 levels;
+    /** Ticks averaged per decision. */
+    u32 window_ticks;
+    /** Step down when the window average exceeds this share of budget. */
+    f32 downgrade_load;
+    /** Step up when the window average stays below this share... */
+    f32 upgrade_load;
+    /** ...for this many windows in a row (doubled after a failed step). */
+    u32 upgrade_windows;
+};
+
+/**
+ * Picks a quality level that keeps the per-tick work within the frame
+ * budget.
+ *
+ * Work times are averaged over fixed windows of ticks. One overloaded
+ * window is enough to step down, while stepping up needs several calm
+ * windows in a row; the gap between the two thresholds and the asymmetric
+ * window counts keep the level from flapping. If a step up is followed by
+ * a step down soon after, the next step up waits twice as long.
+ */
+class QualityGovernor final {
+public:
+    static constexpr u32 MAX_UPGRADE_WINDOWS = 64;
+
+    QualityGovernor(const GovernorConfig& config, u32 initial_level);
+
+    /** Records the work of one tick; returns true if the level changed. */
+    auto observe(time::Duration work) -> bool;
+
+    [[nodiscard]] auto level() const -> u32 { return level_; }
+
+    /** Average work of the last complete window relative to the budget. */
+    [[nodiscard]] auto load() const -> f32 { return load_; }
+
+    [[nodiscard]] auto downgrades() const -> u64 { return downgrades_; }
+    [[nodiscard]] auto upgrades() const -> u64 { return upgrades_; }
+
+private:
+    GovernorConfig config_;
+    u32 level_;
+    u32 required_calm_windows_;
+    u32 calm_windows_{0};
+    u32 windows_since_upgrade_{MAX_UPGRADE_WINDOWS};
+
+    u64 window_ns_{0};
+    u32 window_ticks_{0};
+    f32 load_{0.0f};
+
+    u64 downgrades_{0};
+    u64 upgrades_{0};
+};
+
+} // namespace engine::quality
@@ -0,0 +1,262 @@
+#include "shared_memory.h"
+#include "page_allocator.h"
+#include <string>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace engine::memory {
+
+#if defined(_MSC_FULL_VER)
+
+namespace {
+
+auto segment_name(std::string_view name) -> std::string
+{
+    return std::string{"Local\\"}.append(name);
+}
+
+} // namespace
+
+auto create_shared_memory(std::string_view name, u64 size) -> SharedMapping
+{
+    u64 aligned_size = align_up(size, STANDARD_PAGE_SIZE);
+    HANDLE handle = CreateFileMappingA(
+        INVALID_HANDLE_VALUE,
+        nullptr,
+        PAGE_READWRITE,
+        static_cast<DWORD>(aligned_size >> 32),
+        static_cast<DWORD>(aligned_size),
+        segment_name(name).c_str()
+    );
+    if (handle == nullptr) {
+        return {};
+    }
+
+    void* data = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, aligned_size);
+    if (data == nullptr) {
+        CloseHandle(handle);
+        return {};
+    }
+    return {data, aligned_size, reinterpret_cast<s64>(handle), true};
+}
+
+auto open_shared_memory(std::string_view name) -> SharedMapping
+{
+    HANDLE handle =
+        OpenFileMappingA(FILE_MAP_READ, FALSE, segment_name(name).c_str());
+    if (handle == nullptr) {
+        return {};
+    }
+
+    void* data = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr) {
+        CloseHandle(handle);
+        return {};
+    }
+
+    MEMORY_BASIC_INFORMATION info{};
+    VirtualQuery(data, &info, sizeof(info));
+    return {data, info.RegionSize, reinterpret_cast<s64>(handle), false};
+}
+
+void release_shared_memory(
+    SharedMapping& mapping,
+    [[maybe_unused]] std::string_view name
+)
+{
+    // the segment goes away with the last handle
+    if (mapping.data != nullptr) {
+        UnmapViewOfFile(mapping.data);
+        CloseHandle(reinterpret_cast<HANDLE>(mapping.handle));
+    }
+    mapping = {};
+}
+
+auto map_file(const char* path) -> SharedMapping
+{
+    HANDLE file = CreateFileA(
+        path,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+        return {};
+    }
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return {};
+    }
+
+    // the mapping keeps the file open
+    HANDLE handle =
+        CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (handle == nullptr) {
+        return {};
+    }
+
+    void* data = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr) {
+        CloseHandle(handle);
+        return {};
+    }
+    auto file_size = static_cast<u64>(size.QuadPart);
+    return {data, file_size, reinterpret_cast<s64>(handle), false};
+}
+
+void unmap_file(SharedMapping& mapping)
+{
+    release_shared_memory(mapping, {});
+}
+
+#elif defined(__linux__)
+
+namespace {
+
+auto segment_name(std::string_view name) -> std::string
+{
+    return std::string{"/"}.append(name);
+}
+
+} // namespace
+
+auto create_shared_memory(std::string_view name, u64 size) -> SharedMapping
+{
+    u64 aligned_size = align_up(size, STANDARD_PAGE_SIZE);
+    int fd = shm_open(segment_name(name).c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        return {};
+    }
+    if (ftruncate(fd, static_cast<off_t>(aligned_size)) != 0) {
+        close(fd);
+        return {};
+    }
+
+    void* data = mmap(
+        nullptr,
+        aligned_size,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED,
+        fd,
+        0
+    );
+    if (data == MAP_FAILED) {
+        close(fd);
+        return {};
+    }
+    return {data, aligned_size, fd, true};
+}
+
+auto open_shared_memory(std::string_view name) -> SharedMapping
+{
+    int fd = shm_open(segment_name(name).c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return {};
+    }
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return {};
+    }
+
+    auto size = static_cast<u64>(info.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        close(fd);
+        return {};
+    }
+    return {data, size, fd, false};
+}
+
+void release_shared_memory(SharedMapping& mapping, std::string_view name)
+{
+    if (mapping.data != nullptr) {
+        munmap(mapping.data, mapping.size);
+        close(static_cast<int>(mapping.handle));
+        if (mapping.writable) {
+            shm_unlink(segment_name(name).c_str());
+        }
+    }
+    mapping = {};
+}
+
+auto map_file(const char* path) -> SharedMapping
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return {};
+    }
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return {};
+    }
+
+    // the mapping stays valid after the descriptor is closed
+    auto size = static_cast<u64>(info.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return {};
+    }
+    return {data, size, -1, false};
+}
+
+void unmap_file(SharedMapping& mapping)
+{
+    if (mapping.data != nullptr) {
+        munmap(mapping.data, mapping.size);
+    }
+    mapping = {};
+}
+
+#else
+
+auto create_shared_memory(
+    [[maybe_unused]] std::string_view name,
+    [[maybe_unused]] u64 size
+) -> SharedMapping
+{
+    return {};
+}
+
+auto open_shared_memory([[maybe_unused]] std::string_view name)
+    -> SharedMapping
+{
+    return {};
+}
+
+void release_shared_memory(
+    SharedMapping& mapping,
+    [[maybe_unused]] std::string_view name
+)
+{
+    mapping = {};
+}
+
+auto map_file([[maybe_unused]] const char* path) -> SharedMapping
+{
+    return {};
+}
+
+void unmap_file(SharedMapping& mapping)
+{
+    mapping = {};
+}
+
+#endif
+
+} // namespace engine::memory
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "core.h"
+#include <string_view>
+
+namespace engine::memory {
+
+/**
+ * Named block of memory shared with other processes. Both ends map the
+ * same physical pages, so whatever one side writes the other can read
+ * without copies or system calls.
+ */
+struct SharedMapping {
+    void* data;
+    u64 size;
+    /** Platform handle of the segment; a HANDLE on Windows, an fd on Linux. */
+    s64 handle;
+    bool writable;
+};
+
+/**
+ * Creates (or re-opens) the segment `name` with at least `size` bytes and
+ * maps it for reading and writing. The name is a plain identifier; it is
+ * mapped to "Local\<name>" on Windows and "/<name>" under /dev/shm on Linux.
+ * Returns a mapping with null data on failure.
+ */
+auto create_shared_memory(std::string_view name, u64 size) -> SharedMapping;
+
+/**
+ * Maps an existing segment read-only; the size is taken from the segment.
+ * Returns a mapping with null data if it does not exist.
+ */
+auto open_shared_memory(std::string_view name) -> SharedMapping;
+
+/** Unmaps the segment; the creator also removes its name. */
+void release_shared_memory(SharedMapping& mapping, std::string_view name);
+
+/**
+ * Maps a whole file read-only; pages are loaded from the file on first
+ * touch. Returns a mapping with null data if the file cannot be opened or
+ * is empty.
+ */
+auto map_file(const char* path) -> SharedMapping;
+
+void unmap_file(SharedMapping& mapping);
+
+} // namespace engine::memory
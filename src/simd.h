@@ -0,0 +1,27 @@
+#pragma once
+
+//===========================================================================
+// SIMD INSTRUCTION SET DETECTION
+//===========================================================================
+//
+// Every SIMD code path in the engine must have a scalar fallback; these
+// macros only tell which instruction sets the compiler is allowed to emit
+// for the current build configuration.
+//
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                   \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENGINE_SIMD_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// MSVC has no dedicated SSSE3 switch; /arch:AVX and newer imply it
+#if defined(ENGINE_SIMD_SSE2) && (defined(__SSSE3__) || defined(__AVX__))
+#define ENGINE_SIMD_SSSE3 1
+#include <tmmintrin.h>
+#endif
+
+#if defined(ENGINE_SIMD_SSE2) && defined(__AVX2__)
+#define ENGINE_SIMD_AVX2 1
+#include <immintrin.h>
+#endif
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "core.h"
+#include "page_allocator.h"
+#include <type_traits>
+
+namespace engine::snapshots {
+
+/**
+ * Fixed capacity ring of snapshots of a trivially copyable state, each
+ * tagged with the tick it was taken at.
+ *
+ * Snapshots live in one page allocated block, so taking or restoring one is
+ * a single copy of the state and nothing is allocated after construction.
+ * Ticks must be pushed in increasing order; when the ring is full the
+ * oldest snapshot is overwritten.
+ */
+template <typename T>
+class SnapshotRing final {
+    static_assert(
+        std::is_trivially_copyable_v<T>,
+        "snapshots must be trivially copyable"
+    );
+
+public:
+    static constexpr u32 NONE = ~u32{0};
+
+    explicit SnapshotRing(u32 capacity) :
+        capacity_(capacity),
+        memory_(memory::allocate_pages(capacity * SLOT_SIZE))
+    {
+    }
+
+    ~SnapshotRing() { memory::release_pages(memory_); }
+
+    DELETE_COPY(SnapshotRing);
+    DELETE_MOVE(SnapshotRing);
+
+    /**
+     * Makes room for the snapshot of `tick` and returns its slot; the
+     * caller fills at(slot).
+     */
+    auto push(u64 tick) -> u32
+    {
+        if (count_ == capacity_) {
+            first_ = (first_ + 1) % capacity_;
+            --count_;
+        }
+        u32 slot = (first_ + count_++) % capacity_;
+        entry(slot).tick = tick;
+        return slot;
+    }
+
+    /** Slot of the newest snapshot taken at or before `tick`, or NONE. */
+    [[nodiscard]] auto find(u64 tick) const -> u32
+    {
+        // ticks grow along the ring, so binary search over the logical order
+        u32 low = 0;
+        u32 high = count_;
+        while (low < high) {
+            u32 middle = (low + high) / 2;
+            if (entry(physical(middle)).tick <= tick) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        return low == 0 ? NONE : physical(low - 1);
+    }
+
+    /** Forgets every snapshot taken after `tick`, e.g. after a rewind. */
+    void drop_after(u64 tick)
+    {
+        while (count_ > 0 && entry(physical(count_ - 1)).tick > tick) {
+            --count_;
+        }
+    }
+
+    void clear()
+    {
+        first_ = 0;
+        count_ = 0;
+    }
+
+    auto at(u32 slot) -> T& { return entry(slot).value; }
+    [[nodiscard]] auto at(u32 slot) const -> const T&
+    {
+        return entry(slot).value;
+    }
+
+    [[nodiscard]] auto tick(u32 slot) const -> u64 { return entry(slot).tick; }
+    [[nodiscard]] auto count() const -> u32 { return count_; }
+    [[nodiscard]] auto capacity() const -> u32 { return capacity_; }
+
+private:
+    struct Entry {
+        u64 tick;
+        T value;
+    };
+
+    // slots start on cache line boundaries
+    static constexpr u64 SLOT_SIZE = memory::align_up(sizeof(Entry), 64);
+
+    [[nodiscard]] auto physical(u32 index) const -> u32
+    {
+        return (first_ + index) % capacity_;
+    }
+
+    auto entry(u32 slot) -> Entry&
+    {
+        auto* base = static_cast<u8*>(memory_.data);
+        return *reinterpret_cast<Entry*>(base + slot * SLOT_SIZE);
+    }
+
+    [[nodiscard]] auto entry(u32 slot) const -> const Entry&
+    {
+        const auto* base = static_cast<const u8*>(memory_.data);
+        return *reinterpret_cast<const Entry*>(base + slot * SLOT_SIZE);
+    }
+
+    u32 capacity_;
+    u32 first_{0};
+    u32 count_{0};
+    memory::PageAllocation memory_;
+};
+
+} // namespace engine::snapshots
@@ -0,0 +1,171 @@
+#include "sprite.h"
+#include <algorithm>
+#include <cstring>
+
+namespace engine::graphics {
+
+//===========================================================================
+// RleSprite
+//===========================================================================
+
+auto RleSprite::compile(
+    const ARGB* pixels,
+    s32 width,
+    s32 height,
+    s32 stride,
+    ARGB transparent
+) -> RleSprite
+{
+    RleSprite sprite{};
+    sprite.width_ = width;
+    sprite.height_ = height;
+    sprite.rows_.reserve(static_cast<u64>(height));
+
+    for (s32 y = 0; y < height; ++y) {
+        const ARGB* row = pixels + static_cast<s64>(y) * stride;
+        Row rle_row{static_cast<u32>(sprite.spans_.size()), 0};
+
+        s32 x = 0;
+        while (x < width) {
+            // skip the transparent run
+            while (x < width && row[x].value == transparent.value) {
+                ++x;
+            }
+            if (x == width) {
+                break;
+            }
+
+            // collect the opaque run
+            s32 start = x;
+            while (x < width && row[x].value != transparent.value) {
+                ++x;
+            }
+
+            sprite.spans_.push_back({
+                static_cast<u16>(start),                 // x
+                static_cast<u16>(x - start),             // length
+                static_cast<u32>(sprite.pixels_.size()), // pixel_offset
+            });
+            sprite.pixels_.insert(sprite.pixels_.end(), row + start, row + x);
+            ++rle_row.span_count;
+        }
+
+        sprite.rows_.push_back(rle_row);
+    }
+
+    return sprite;
+}
+
+auto RleSprite::compile_mask(
+    const char* const* rows,
+    s32 height,
+    ARGB color,
+    s32 scale
+) -> RleSprite
+{
+    s32 width = 0;
+    for (s32 y = 0; y < height; ++y) {
+        width = std::max(width, static_cast<s32>(std::strlen(rows[y])));
+    }
+
+    // expand the mask into a temporary color keyed pixel array so that
+    // compile() is the only place that knows the RLE layout
+    ARGB transparent{};
+    transparent.value = ~color.value;
+
+    s32 scaled_width = width * scale;
+    s32 scaled_height = height * scale;
+    std::vector<ARGB> pixels(
+        static_cast<u64>(scaled_width) * static_cast<u64>(scaled_height),
+        transparent
+    );
+
+    for (s32 y = 0; y < height; ++y) {
+        auto length = static_cast<s32>(std::strlen(rows[y]));
+        for (s32 x = 0; x < length; ++x) {
+            if (rows[y][x] != '#') {
+                continue;
+            }
+            for (s32 sy = 0; sy < scale; ++sy) {
+                ARGB* target = pixels.data() +
+                               static_cast<s64>(y * scale + sy) * scaled_width +
+                               x * scale;
+                std::fill_n(target, scale, color);
+            }
+        }
+    }
+
+    return compile(
+        pixels.data(),
+        scaled_width,
+        scaled_height,
+        scaled_width,
+        transparent
+    );
+}
+
+//===========================================================================
+// Blitting
+//===========================================================================
+
+void sprite_blit(
+    ScreenBuffer& screen_buffer,
+    const RleSprite& sprite,
+    s32 x,
+    s32 y
+)
+{
+    // resolve the visible part of the sprite once
+    s32 row_begin = std::max(0, -y);
+    s32 row_end = std::min(sprite.height_, screen_buffer.height - y);
+    s32 column_begin = std::max(0, -x);
+    s32 column_end = std::min(sprite.width_, screen_buffer.width - x);
+    if (row_begin >= row_end || column_begin >= column_end) {
+        return;
+    }
+
+    const ARGB* source = sprite.pixels_.data();
+    ARGB* target = screen_buffer.pixels +
+                   static_cast<s64>(y + row_begin) * screen_buffer.width;
+
+    bool horizontally_clipped = column_begin > 0 || column_end < sprite.width_;
+    if (!horizontally_clipped) {
+        // fast path; every span of the visible rows is copied as is
+        for (s32 row = row_begin; row < row_end; ++row) {
+            const auto& rle_row = sprite.rows_[static_cast<u64>(row)];
+            const auto* span = sprite.spans_.data() + rle_row.first_span;
+            const auto* spans_end = span + rle_row.span_count;
+            for (; span < spans_end; ++span) {
+                std::memcpy(
+                    target + (x + span->x),
+                    source + span->pixel_offset,
+                    span->length * sizeof(ARGB)
+                );
+            }
+            target += screen_buffer.width;
+        }
+        return;
+    }
+
+    // slow path; trim the spans that cross the left or right edge
+    for (s32 row = row_begin; row < row_end; ++row) {
+        const auto& rle_row = sprite.rows_[static_cast<u64>(row)];
+        const auto* span = sprite.spans_.data() + rle_row.first_span;
+        const auto* spans_end = span + rle_row.span_count;
+        for (; span < spans_end; ++span) {
+            s32 begin = std::max<s32>(span->x, column_begin);
+            s32 end = std::min<s32>(span->x + span->length, column_end);
+            if (begin >= end) {
+                continue;
+            }
+            std::memcpy(
+                target + (x + begin),
+                source + span->pixel_offset + (begin - span->x),
+                static_cast<u64>(end - begin) * sizeof(ARGB)
+            );
+        }
+        target += screen_buffer.width;
+    }
+}
+
+} // namespace engine::graphics
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "core.h"
+#include "graphics.h"
+#include <vector>
+
+namespace engine::graphics {
+
+//===========================================================================
+// RleSprite
+//===========================================================================
+
+/**
+ * Sprite compiled into run-length encoded opaque spans. Transparent runs are
+ * not stored at all, so blitting is a sequence of straight copies of the
+ * opaque spans into the target buffer.
+ */
+class RleSprite final {
+    friend void sprite_blit(
+        ScreenBuffer& screen_buffer,
+        const RleSprite& sprite,
+        s32 x,
+        s32 y
+    );
+
+public:
+    DEFAULT_CTOR(RleSprite);
+    DEFAULT_DTOR(RleSprite);
+    DEFAULT_COPY(RleSprite);
+    DEFAULT_MOVE(RleSprite);
+
+    /**
+     * Compiles a sprite from a pixel array. Pixels matching the given
+     * transparent color key are skipped.
+     */
+    static auto compile(
+        const ARGB* pixels,
+        s32 width,
+        s32 height,
+        s32 stride,
+        ARGB transparent
+    ) -> RleSprite;
+
+    /**
+     * Compiles a single color sprite from a text mask where '#' marks an
+     * opaque pixel. Each mask pixel is expanded to scale x scale pixels.
+     */
+    static auto compile_mask(
+        const char* const* rows,
+        s32 height,
+        ARGB color,
+        s32 scale = 1
+    ) -> RleSprite;
+
+    [[nodiscard]] auto width() const -> s32 { return width_; }
+    [[nodiscard]] auto height() const -> s32 { return height_; }
+    [[nodiscard]] auto opaque_pixel_count() const -> u64
+    {
+        return pixels_.size();
+    }
+
+private:
+    struct Span {
+        u16 x;
+        u16 length;
+        u32 pixel_offset;
+    };
+
+    struct Row {
+        u32 first_span;
+        u32 span_count;
+    };
+
+    s32 width_{0};
+    s32 height_{0};
+    std::vector<Row> rows_{};
+    std::vector<Span> spans_{};
+    std::vector<ARGB> pixels_{};
+};
+
+/**
+ * Draws the sprite with its upper-left corner at (x, y). Clipping against the
+ * screen buffer bounds is resolved once per sprite (and per span on the
+ * clipped edges), never per pixel.
+ */
+void sprite_blit(
+    ScreenBuffer& screen_buffer,
+    const RleSprite& sprite,
+    s32 x,
+    s32 y
+);
+
+} // namespace engine::graphics
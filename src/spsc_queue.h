@@ -0,0 +1,108 @@
+#pragma once
+
+#include "core.h"
+#include <array>
+#include <atomic>
+#include <type_traits>
+
+namespace engine::sync {
+
+/** Assumed size of a cache line; used to keep producer and consumer apart. */
+constexpr u64 CACHE_LINE_SIZE = 64;
+
+//===========================================================================
+// SpscQueue
+//===========================================================================
+
+/**
+ * Bounded lock-free single-producer single-consumer queue.
+ *
+ * Exactly one thread may push and exactly one (other) thread may pop. Both
+ * sides keep a cached copy of the opposite index so that the shared cache
+ * lines are only touched when the queue looks full or empty.
+ */
+template <typename T, u32 Capacity>
+class SpscQueue final {
+    static_assert(
+        Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+        "SpscQueue capacity must be a power of two"
+    );
+    static_assert(
+        std::is_trivially_copyable_v<T>,
+        "SpscQueue can only hold trivially copyable types"
+    );
+
+public:
+    DEFAULT_CTOR(SpscQueue);
+    DEFAULT_DTOR(SpscQueue);
+    DELETE_COPY(SpscQueue);
+    DELETE_MOVE(SpscQueue);
+
+    static constexpr u32 CAPACITY = Capacity;
+
+    /** Producer side. Returns false if the queue is full. */
+    auto try_push(const T& value) -> bool
+    {
+        u32 head = head_.load(std::memory_order_relaxed);
+        if (head - tail_cache_ == Capacity) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head - tail_cache_ == Capacity) {
+                return false;
+            }
+        }
+
+        slots_[head & MASK] = value;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Consumer side. Returns false if the queue is empty. */
+    auto try_pop(T& value) -> bool
+    {
+        if (!try_peek(value)) {
+            return false;
+        }
+        tail_.store(
+            tail_.load(std::memory_order_relaxed) + 1,
+            std::memory_order_release
+        );
+        return true;
+    }
+
+    /** Consumer side. Reads the oldest element without removing it. */
+    auto try_peek(T& value) -> bool
+    {
+        u32 tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_cache_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail == head_cache_) {
+                return false;
+            }
+        }
+
+        value = slots_[tail & MASK];
+        return true;
+    }
+
+    /** Approximate number of queued elements; exact only when idle. */
+    [[nodiscard]] auto size() const -> u32
+    {
+        return head_.load(std::memory_order_acquire) -
+               tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr u32 MASK = Capacity - 1;
+
+    // producer owned
+    alignas(CACHE_LINE_SIZE) std::atomic<u32> head_{0};
+    u32 tail_cache_{0};
+
+    // consumer owned
+    alignas(CACHE_LINE_SIZE) std::atomic<u32> tail_{0};
+    u32 head_cache_{0};
+
+    alignas(CACHE_LINE_SIZE) std::array<T, Capacity> slots_{};
+};
+
+} // namespace engine::sync
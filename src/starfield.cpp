@@ -0,0 +1,157 @@
+#include "starfield.h"
+#include "simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace engine::graphics {
+
+namespace {
+
+/** Adds the source row to the target row, saturating each channel. */
+void add_row(ARGB* target, const ARGB* source, u64 count)
+{
+    u64 i = 0;
+#if defined(ENGINE_SIMD_AVX2)
+    for (; i + 8 <= count; i += 8) {
+        auto* out = reinterpret_cast<__m256i*>(target + i);
+        __m256i a = _mm256_loadu_si256(out);
+        __m256i b =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+        _mm256_storeu_si256(out, _mm256_adds_epu8(a, b));
+    }
+#elif defined(ENGINE_SIMD_SSE2)
+    for (; i + 4 <= count; i += 4) {
+        auto* out = reinterpret_cast<__m128i*>(target + i);
+        __m128i a = _mm_loadu_si128(out);
+        __m128i b =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        _mm_storeu_si128(out, _mm_adds_epu8(a, b));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        for (u32 channel = 0; channel < 4; ++channel) {
+            u32 sum = target[i].data[channel] + source[i].data[channel];
+            target[i].data[channel] = static_cast<u8>(std::min(sum, 0xffu));
+        }
+    }
+}
+
+/** Offset into a wrapping extent; also for negative positions. */
+auto wrap_offset(f32 position, s32 extent) -> s32
+{
+    auto offset = static_cast<s64>(std::floor(position)) % extent;
+    return static_cast<s32>(offset < 0 ? offset + extent : offset);
+}
+
+void draw_stars(ScreenBuffer& tile, const StarLayerConfig& config, u32 seed)
+{
+    std::minstd_rand random{seed};
+    std::uniform_int_distribution<s32> xs{0, tile.width - 1};
+    std::uniform_int_distribution<s32> ys{0, tile.height - 1};
+    std::uniform_int_distribution<u32> levels{config.brightness / 2u,
+                                              config.brightness};
+    std::uniform_int_distribution<u32> tints{0, 2};
+
+    for (u32 i = 0; i < config.star_count; ++i) {
+        s32 x = xs(random);
+        s32 y = ys(random);
+        auto level = static_cast<u8>(levels(random));
+        auto dim = static_cast<u8>(level * 3 / 4);
+
+        // mostly white, some bluish or yellowish
+        ARGB color{};
+        switch (tints(random)) {
+            case 0:
+                color = argb_create(dim, dim, level);
+                break;
+            case 1:
+                color = argb_create(level, level, dim);
+                break;
+            default:
+                color = argb_create(level, level, level);
+        }
+
+        // stars wrap around the tile edges like the tile itself
+        for (s32 dy = 0; dy < config.star_size; ++dy) {
+            for (s32 dx = 0; dx < config.star_size; ++dx) {
+                auto px = static_cast<u64>((x + dx) % tile.width);
+                auto py = static_cast<u64>((y + dy) % tile.height);
+                tile.pixels[py * static_cast<u64>(tile.width) + px] = color;
+            }
+        }
+    }
+}
+
+} // namespace
+
+Starfield::~Starfield()
+{
+    release();
+}
+
+void Starfield::init(std::span<const StarLayerConfig> layers)
+{
+    release();
+
+    u32 seed = 1;
+    for (const auto& config : layers) {
+        Layer layer{config, {}};
+        screen_buffer_allocate(
+            layer.tile,
+            config.tile_width,
+            config.tile_height
+        );
+        screen_buffer_fill(layer.tile, argb_create(0x00, 0x00, 0x00));
+        draw_stars(layer.tile, config, seed++);
+        layers_.push_back(layer);
+    }
+}
+
+void Starfield::release()
+{
+    for (auto& layer : layers_) {
+        screen_buffer_release(layer.tile);
+    }
+    layers_.clear();
+}
+
+void Starfield::draw(ScreenBuffer& target, math::vec2 scroll, u32 layer_count)
+    const
+{
+    layer_count = std::min(layer_count, this->layer_count());
+    auto width = static_cast<u64>(target.width);
+
+    for (u32 l = 0; l < layer_count; ++l) {
+        const Layer& layer = layers_[l];
+        const ScreenBuffer& tile = layer.tile;
+        auto tile_width = static_cast<u64>(tile.width);
+        s32 offset_x =
+            wrap_offset(scroll.x * layer.config.parallax, tile.width);
+        s32 offset_y =
+            wrap_offset(scroll.y * layer.config.parallax, tile.height);
+
+        for (s32 y = 0; y < target.height; ++y) {
+            ARGB* out = target.pixels + static_cast<u64>(y) * width;
+            auto row = static_cast<u64>((y + offset_y) % tile.height);
+            const ARGB* in = tile.pixels + row * tile_width;
+
+            // the row is the tile row repeated from the scroll offset on
+            auto column = static_cast<u64>(offset_x);
+            for (u64 x = 0; x < width;) {
+                u64 count = std::min(tile_width - column, width - x);
+                if (layer.config.opaque) {
+                    std::memcpy(out + x, in + column, count * sizeof(ARGB));
+                } else {
+                    add_row(out + x, in + column, count);
+                }
+                x += count;
+                column = 0;
+            }
+        }
+    }
+}
+
+} // namespace engine::graphics
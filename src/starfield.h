@@ -0,0 +1,76 @@
+#pragma once
+
+#include "core.h"
+#include "graphics.h"
+#include "vecmath.h"
+#include <span>
+#include <vector>
+
+namespace engine::graphics {
+
+struct StarLayerConfig {
+    /** Size of the tile the layer repeats in both directions. */
+    s32 tile_width;
+    s32 tile_height;
+    u32 star_count;
+    /** Channel value of the brightest stars. */
+    u8 brightness;
+    /** Stars are squares of this many pixels. */
+    s32 star_size;
+    /** Share of the camera movement the layer follows; far layers less. */
+    f32 parallax;
+    /** Copied over the target; otherwise added to it. */
+    bool opaque;
+};
+
+//===========================================================================
+// Starfield
+//===========================================================================
+
+/**
+ * Parallax star background made of pre-rendered layers.
+ *
+ * Every layer is drawn once into a tile that wraps around in both
+ * directions. A frame only composites the tiles at their scroll offsets:
+ * opaque layers are copied row by row with memcpy, translucent ones are
+ * added with saturating SIMD adds. Nothing is rasterized per frame.
+ */
+class Starfield final {
+public:
+    DEFAULT_CTOR(Starfield);
+    DELETE_COPY(Starfield);
+    DELETE_MOVE(Starfield);
+
+    ~Starfield();
+
+    /**
+     * Renders the tiles. Stars come from a fixed seed, so the field looks
+     * the same every run and leaves the game's random sequence alone.
+     */
+    void init(std::span<const StarLayerConfig> layers);
+
+    void release();
+
+    /**
+     * Composites the first `layer_count` layers, each scrolled by `scroll`
+     * times its parallax. The first layer must be opaque; it covers the
+     * whole target, so the target needs no clearing beforehand.
+     */
+    void draw(ScreenBuffer& target, math::vec2 scroll, u32 layer_count)
+        const;
+
+    [[nodiscard]] auto layer_count() const -> u32
+    {
+        return static_cast<u32>(layers_.size());
+    }
+
+private:
+    struct Layer {
+        StarLayerConfig config;
+        ScreenBuffer tile;
+    };
+
+    std::vector<Layer> layers_{};
+};
+
+} // namespace engine::graphics
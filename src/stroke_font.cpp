@@ -0,0 +1,248 @@
+#include "stroke_font.h"
+#include <algorithm>
+
+namespace engine::graphics {
+
+namespace {
+
+struct GlyphStrokes {
+    char character;
+    /**
+     * Polylines as "xy" grid points, (0, 0) being the top left corner;
+     * '|' lifts the pen.
+     */
+    const char* strokes;
+};
+
+// clang-format off
+constexpr GlyphStrokes GLYPH_STROKES[] = {
+    {'0', "0040460600|4006"},
+    {'1', "112026|0646"},
+    {'2', "004043030646"},
+    {'3', "00404606|0343"},
+    {'4', "000343|4046"},
+    {'5', "4000023243453606"},
+    {'6', "400006464303"},
+    {'7', "004016"},
+    {'8', "0040460600|0343"},
+    {'9', "430300404606"},
+    {'A', "0602204246|0444"},
+    {'B', "06003041423303|3344453606"},
+    {'C', "40000646"},
+    {'D', "00304244360600"},
+    {'E', "40000646|0333"},
+    {'F', "400006|0333"},
+    {'G', "400006464323"},
+    {'H', "0006|4046|0343"},
+    {'I', "0040|2026|0646"},
+    {'J', "40460604"},
+    {'K', "0006|400346"},
+    {'L', "000646"},
+    {'M', "0600234046"},
+    {'N', "06004640"},
+    {'O', "0040460600"},
+    {'P', "0600404303"},
+    {'Q', "0040460600|2446"},
+    {'R', "060040430346"},
+    {'S', "400003434606"},
+    {'T', "0040|2026"},
+    {'U', "00064640"},
+    {'V', "002640"},
+    {'W', "0006234640"},
+    {'X', "0046|4006"},
+    {'Y', "002340|2326"},
+    {'Z', "00400646"},
+    {':', "0102|0405"},
+    {'.', "0506"},
+    {'-', "0343"},
+    {'+', "0343|2125"},
+    {'=', "0242|0444"},
+    {'/', "0640"},
+    {'%', "0640|0001|4546"},
+    {'!', "0004|0506"},
+    {'?', "0040422223|2526"},
+    {'(', "20111526"},
+    {')', "00111506"},
+};
+// clang-format on
+
+/** Rightmost grid column the glyph touches. */
+auto strokes_width(const char* strokes) -> s32
+{
+    s32 width = 0;
+    for (const char* c = strokes; *c != '\0'; c += *c == '|' ? 1 : 2) {
+        if (*c != '|') {
+            width = std::max(width, c[0] - '0');
+        }
+    }
+    return width;
+}
+
+void draw_strokes(
+    ScreenBuffer& target,
+    const char* strokes,
+    f32 unit,
+    s32 thickness,
+    ARGB color
+)
+{
+    bool pen_down = false;
+    f32 last_x = 0.0f;
+    f32 last_y = 0.0f;
+    for (const char* c = strokes; *c != '\0';) {
+        if (*c == '|') {
+            pen_down = false;
+            ++c;
+            continue;
+        }
+
+        auto x = static_cast<f32>(c[0] - '0') * unit;
+        auto y = static_cast<f32>(c[1] - '0') * unit;
+        c += 2;
+        if (pen_down) {
+            // thick strokes are the line repeated with an offset
+            for (s32 dy = 0; dy < thickness; ++dy) {
+                for (s32 dx = 0; dx < thickness; ++dx) {
+                    auto ox = static_cast<f32>(dx);
+                    auto oy = static_cast<f32>(dy);
+                    screen_buffer_draw_line(
+                        target,
+                        last_x + ox,
+                        last_y + oy,
+                        x + ox,
+                        y + oy,
+                        color
+                    );
+                }
+            }
+        }
+        pen_down = true;
+        last_x = x;
+        last_y = y;
+    }
+}
+
+} // namespace
+
+//===========================================================================
+// StrokeFont
+//===========================================================================
+
+auto StrokeFont::create(ARGB color, s32 size) -> StrokeFont
+{
+    StrokeFont font{};
+    font.size_ = std::max(size, GRID_HEIGHT);
+    font.glyph_index_.fill(NO_GLYPH);
+    font.glyphs_.reserve(std::size(GLYPH_STROKES));
+    font.advances_.reserve(std::size(GLYPH_STROKES));
+
+    f32 unit =
+        static_cast<f32>(font.size_ - 1) / static_cast<f32>(GRID_HEIGHT);
+    s32 thickness = std::max(font.size_ / 12, 1);
+    s32 gap = static_cast<s32>(unit * 1.5f) + thickness;
+    font.space_advance_ =
+        static_cast<s32>(unit * static_cast<f32>(GRID_WIDTH)) + gap;
+
+    // every glyph is drawn into the same scratch buffer and compiled from
+    // there; black is the transparent key
+    s32 cell_width = font.size_ + thickness;
+    s32 cell_height = font.size_ + thickness;
+    std::vector<ARGB> scratch(static_cast<u64>(cell_width * cell_height));
+    ScreenBuffer cell{
+        scratch.data(),                // pixels
+        scratch.size(),                // pixels_size
+        cell_width,                    // width
+        cell_height,                   // height
+        static_cast<u32>(cell_height), // scanlines
+        {},                            // memory
+    };
+
+    for (const auto& glyph : GLYPH_STROKES) {
+        std::fill(scratch.begin(), scratch.end(), ARGB{0});
+        draw_strokes(cell, glyph.strokes, unit, thickness, color);
+
+        // one pixel of slack for rounding in the rasterizer
+        auto columns = static_cast<f32>(strokes_width(glyph.strokes));
+        s32 width = std::min(
+            static_cast<s32>(columns * unit) + thickness + 1,
+            cell_width
+        );
+        auto index = static_cast<u8>(font.glyphs_.size());
+        font.glyph_index_[static_cast<u8>(glyph.character)] = index;
+        font.glyphs_.push_back(RleSprite::compile(
+            scratch.data(),
+            width,
+            cell_height,
+            cell_width,
+            ARGB{0}
+        ));
+        font.advances_.push_back(width + gap);
+    }
+
+    return font;
+}
+
+auto StrokeFont::glyph_index(char character) const -> u8
+{
+    auto code = static_cast<u8>(character);
+    if (code >= 'a' && code <= 'z') {
+        code = static_cast<u8>(code - 'a' + 'A');
+    }
+    return code < glyph_index_.size() ? glyph_index_[code] : NO_GLYPH;
+}
+
+auto StrokeFont::advance(char character) const -> s32
+{
+    u8 index = glyph_index(character);
+    return index != NO_GLYPH ? advances_[index] : space_advance_;
+}
+
+//===========================================================================
+// TextLayout
+//===========================================================================
+
+auto TextLayout::set_text(const StrokeFont& font, std::string_view text)
+    -> bool
+{
+    if (font_ == &font && text == text_) {
+        return false;
+    }
+    font_ = &font;
+    text_.assign(text);
+    glyphs_.clear();
+
+    s32 x = 0;
+    s32 y = 0;
+    width_ = 0;
+    height_ = 0;
+    for (char character : text) {
+        if (character == '\n') {
+            x = 0;
+            y += font.line_height();
+            continue;
+        }
+        u8 glyph = font.glyph_index(character);
+        if (glyph != StrokeFont::NO_GLYPH) {
+            glyphs_.push_back({glyph, x, y});
+            const RleSprite& sprite = font.glyph(glyph);
+            width_ = std::max(width_, x + sprite.width());
+            height_ = std::max(height_, y + sprite.height());
+        }
+        x += font.advance(character);
+    }
+    return true;
+}
+
+void TextLayout::draw(ScreenBuffer& screen_buffer, s32 x, s32 y) const
+{
+    for (const auto& placed : glyphs_) {
+        sprite_blit(
+            screen_buffer,
+            font_->glyph(placed.glyph),
+            x + placed.x,
+            y + placed.y
+        );
+    }
+}
+
+} // namespace engine::graphics
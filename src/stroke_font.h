@@ -0,0 +1,119 @@
+#pragma once
+
+#include "core.h"
+#include "graphics.h"
+#include "sprite.h"
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace engine::graphics {
+
+//===========================================================================
+// StrokeFont
+//===========================================================================
+
+/**
+ * Built-in vector font in the style of the arcade original: every glyph is
+ * a few line strokes on a 4x6 grid, so it can be rendered at any size.
+ *
+ * The strokes are rasterized once when the font is created; the glyph
+ * cache holds one RleSprite per glyph at that size, and drawing text is
+ * just sprite blits. Glyphs are proportional, e.g. '1' and ':' are
+ * narrower than 'M'. Lower case letters are drawn as upper case, other
+ * unknown characters are skipped.
+ */
+class StrokeFont final {
+public:
+    DEFAULT_CTOR(StrokeFont);
+    DEFAULT_DTOR(StrokeFont);
+    DEFAULT_COPY(StrokeFont);
+    DEFAULT_MOVE(StrokeFont);
+
+    static constexpr s32 GRID_WIDTH = 4;
+    static constexpr s32 GRID_HEIGHT = 6;
+
+    /**
+     * Rasterizes the glyphs `size` pixels tall (at least GRID_HEIGHT).
+     * The color must not be black, which is the transparent key.
+     */
+    static auto create(ARGB color, s32 size) -> StrokeFont;
+
+    /**
+     * Horizontal distance from this glyph's origin to the next one;
+     * characters without a glyph advance like a space.
+     */
+    [[nodiscard]] auto advance(char character) const -> s32;
+
+    /** Vertical distance between two consecutive lines of text. */
+    [[nodiscard]] auto line_height() const -> s32
+    {
+        return size_ + size_ / 2;
+    }
+
+    [[nodiscard]] auto size() const -> s32 { return size_; }
+
+    static constexpr u8 NO_GLYPH = 0xff;
+
+    /** Index of the glyph in the cache, or NO_GLYPH. */
+    [[nodiscard]] auto glyph_index(char character) const -> u8;
+
+    [[nodiscard]] auto glyph(u8 index) const -> const RleSprite&
+    {
+        return glyphs_[index];
+    }
+
+private:
+    s32 size_{0};
+    s32 space_advance_{0};
+    std::array<u8, 128> glyph_index_{};
+    std::vector<RleSprite> glyphs_{};
+    std::vector<s32> advances_{};
+};
+
+//===========================================================================
+// TextLayout
+//===========================================================================
+
+/**
+ * Glyph positions of one piece of text, e.g. a HUD counter.
+ *
+ * Laying out the same text with the same font again keeps the previous
+ * layout, so text that rarely changes costs only the blits. '\n' starts a
+ * new line.
+ */
+class TextLayout final {
+public:
+    DEFAULT_CTOR(TextLayout);
+    DEFAULT_DTOR(TextLayout);
+    DEFAULT_COPY(TextLayout);
+    DEFAULT_MOVE(TextLayout);
+
+    /**
+     * Returns false if the text was unchanged and nothing was done. The
+     * font must stay alive and unchanged while the layout is drawn.
+     */
+    auto set_text(const StrokeFont& font, std::string_view text) -> bool;
+
+    /** Draws the text with the upper-left corner of its box at (x, y). */
+    void draw(ScreenBuffer& screen_buffer, s32 x, s32 y) const;
+
+    [[nodiscard]] auto width() const -> s32 { return width_; }
+    [[nodiscard]] auto height() const -> s32 { return height_; }
+
+private:
+    struct PlacedGlyph {
+        u8 glyph;
+        s32 x;
+        s32 y;
+    };
+
+    const StrokeFont* font_{nullptr};
+    std::string text_{};
+    std::vector<PlacedGlyph> glyphs_{};
+    s32 width_{0};
+    s32 height_{0};
+};
+
+} // namespace engine::graphics
@@ -0,0 +1,147 @@
+#include "tasks.h"
+#include <algorithm>
+#include <new>
+
+namespace engine::tasks {
+
+//===========================================================================
+// Frame allocation
+//===========================================================================
+
+namespace {
+
+constexpr std::size_t SIZE_CLASSES[] = {128, 256, 512, 1024};
+constexpr std::size_t SIZE_CLASS_COUNT = std::size(SIZE_CLASSES);
+constexpr std::size_t FRAMES_PER_CHUNK = 16;
+
+struct FreeFrame {
+    FreeFrame* next;
+};
+
+/**
+ * Free lists of released frames. Memory is carved from chunks that are
+ * never returned, which keeps the pool trivially destructible: schedulers
+ * with static storage may still release frames during shutdown. Tasks run
+ * on the game thread only.
+ */
+struct FramePool {
+    FreeFrame* free_lists[SIZE_CLASS_COUNT];
+
+    void refill(std::size_t size_class)
+    {
+        std::size_t frame_size = SIZE_CLASSES[size_class];
+        auto* chunk = static_cast<std::byte*>(
+            ::operator new(frame_size * FRAMES_PER_CHUNK)
+        );
+
+        for (std::size_t i = 0; i < FRAMES_PER_CHUNK; ++i) {
+            auto* frame = new (chunk + i * frame_size) FreeFrame{};
+            frame->next = free_lists[size_class];
+            free_lists[size_class] = frame;
+        }
+    }
+};
+
+constinit FramePool g_frame_pool{};
+
+auto size_class_of(std::size_t size) -> std::size_t
+{
+    std::size_t size_class = 0;
+    while (size_class < SIZE_CLASS_COUNT && SIZE_CLASSES[size_class] < size) {
+        ++size_class;
+    }
+    return size_class;
+}
+
+} // namespace
+
+auto frame_allocate(std::size_t size) -> void*
+{
+    std::size_t size_class = size_class_of(size);
+    if (size_class == SIZE_CLASS_COUNT) {
+        return ::operator new(size);
+    }
+
+    auto& pool = g_frame_pool;
+    if (pool.free_lists[size_class] == nullptr) {
+        pool.refill(size_class);
+    }
+    FreeFrame* frame = pool.free_lists[size_class];
+    pool.free_lists[size_class] = frame->next;
+    return frame;
+}
+
+void frame_release(void* frame, std::size_t size)
+{
+    std::size_t size_class = size_class_of(size);
+    if (size_class == SIZE_CLASS_COUNT) {
+        ::operator delete(frame);
+        return;
+    }
+
+    auto& pool = g_frame_pool;
+    auto* free_frame = new (frame) FreeFrame{};
+    free_frame->next = pool.free_lists[size_class];
+    pool.free_lists[size_class] = free_frame;
+}
+
+//===========================================================================
+// Scheduler
+//===========================================================================
+
+namespace {
+
+constexpr auto wakes_later = [](const auto& lhs, const auto& rhs) {
+    return lhs.wake_up > rhs.wake_up;
+};
+
+} // namespace
+
+Scheduler::~Scheduler()
+{
+    cancel_all();
+}
+
+void Scheduler::cancel_all()
+{
+    for (auto* queue : {&time_waiters_, &tick_waiters_}) {
+        for (auto& waiter : *queue) {
+            waiter.handle.destroy();
+        }
+        queue->clear();
+    }
+}
+
+void Scheduler::spawn(Task task)
+{
+    task.release().resume();
+}
+
+void Scheduler::tick(time::Duration delta)
+{
+    now_ns_ += delta.nanosecond_value();
+    ++tick_;
+
+    resume_due(time_waiters_, now_ns_);
+    resume_due(tick_waiters_, tick_);
+}
+
+void Scheduler::wait(std::vector<Waiter>& queue, Waiter waiter)
+{
+    queue.push_back(waiter);
+    std::push_heap(queue.begin(), queue.end(), wakes_later);
+}
+
+void Scheduler::resume_due(std::vector<Waiter>& queue, u64 now)
+{
+    // a resumed task may suspend again and push into the same heap, so the
+    // waiter is removed before resuming it
+    while (!queue.empty() && queue.front().wake_up <= now) {
+        std::pop_heap(queue.begin(), queue.end(), wakes_later);
+        auto handle = queue.back().handle;
+        queue.pop_back();
+        handle.resume();
+    }
+}
+
+} // namespace engine::tasks
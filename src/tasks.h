@@ -0,0 +1,197 @@
+#pragma once
+
+#include "core.h"
+#include "time.h"
+#include <coroutine>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace engine::tasks {
+
+//===========================================================================
+// Frame allocation
+//===========================================================================
+
+/**
+ * Coroutine frames come from per size class free lists so that starting a
+ * script during gameplay does not hit the general purpose heap. Frames
+ * larger than the biggest size class fall back to operator new.
+ */
+auto frame_allocate(std::size_t size) -> void*;
+void frame_release(void* frame, std::size_t size);
+
+//===========================================================================
+// Task
+//===========================================================================
+
+/**
+ * Fire-and-forget coroutine run by a Scheduler.
+ *
+ * A task does nothing until it is handed to Scheduler::spawn(); from then on
+ * the scheduler owns it. The frame is released as soon as the coroutine
+ * returns.
+ */
+class Task final {
+public:
+    struct promise_type {
+        static auto operator new(std::size_t size) -> void*
+        {
+            return frame_allocate(size);
+        }
+
+        static void operator delete(void* frame, std::size_t size)
+        {
+            frame_release(frame, size);
+        }
+
+        auto get_return_object() -> Task
+        {
+            return Task{
+                std::coroutine_handle<promise_type>::from_promise(*this)
+            };
+        }
+
+        auto initial_suspend() noexcept -> std::suspend_always { return {}; }
+        auto final_suspend() noexcept -> std::suspend_never { return {}; }
+        void return_void() {}
+        void unhandled_exception() { PANICM("unhandled exception in task"); }
+    };
+
+    DELETE_COPY(Task);
+
+    Task(Task&& other) noexcept :
+        handle_(std::exchange(other.handle_, nullptr))
+    {
+    }
+
+    auto operator=(Task&& other) noexcept -> Task&
+    {
+        if (this != &other) {
+            reset();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    ~Task() { reset(); }
+
+    /** Gives up ownership of the coroutine. */
+    auto release() -> std::coroutine_handle<>
+    {
+        return std::exchange(handle_, nullptr);
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle_{};
+
+    explicit Task(std::coroutine_handle<promise_type> handle) :
+        handle_(handle)
+    {
+    }
+
+    void reset()
+    {
+        if (handle_) {
+            handle_.destroy();
+            handle_ = nullptr;
+        }
+    }
+};
+
+//===========================================================================
+// Scheduler
+//===========================================================================
+
+/**
+ * Resumes suspended tasks once the game time or tick count they wait for
+ * has been reached.
+ *
+ * Waiting tasks sit in min-heaps ordered by their wake up point, so a tick
+ * only looks at the heap tops: a suspended task costs nothing until it is
+ * due. Game time is advanced by the caller, which keeps scripts in step
+ * with the simulation rather than the wall clock.
+ */
+class Scheduler final {
+public:
+    DEFAULT_CTOR(Scheduler);
+    DELETE_COPY(Scheduler);
+    DELETE_MOVE(Scheduler);
+
+    /** Destroys all tasks that are still suspended. */
+    ~Scheduler();
+
+    /** Starts the task; it runs until its first suspension point. */
+    void spawn(Task task);
+
+    /** Destroys all waiting tasks without resuming them. */
+    void cancel_all();
+
+    /**
+     * Advances the game time by `delta` and the tick count by one, then
+     * resumes every task that became due.
+     */
+    void tick(time::Duration delta);
+
+    /** Awaitable that suspends the task for `duration` of game time. */
+    [[nodiscard]] auto sleep(time::Duration duration);
+
+    /** Awaitable that suspends the task for `count` ticks. */
+    [[nodiscard]] auto sleep_ticks(u64 count);
+
+    /** Number of tasks currently waiting. */
+    [[nodiscard]] auto waiting() const -> u64
+    {
+        return time_waiters_.size() + tick_waiters_.size();
+    }
+
+private:
+    struct Waiter {
+        u64 wake_up;
+        std::coroutine_handle<> handle;
+    };
+
+    /** Awaiter for both sleep kinds; `queue` selects the heap. */
+    struct Sleep {
+        std::vector<Waiter>& queue;
+        u64 wake_up;
+        u64 now;
+
+        [[nodiscard]] auto await_ready() const -> bool
+        {
+            return wake_up <= now;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            wait(queue, {wake_up, handle});
+        }
+
+        void await_resume() {}
+    };
+
+    // game time in nanoseconds since the scheduler was created
+    u64 now_ns_{0};
+    u64 tick_{0};
+    std::vector<Waiter> time_waiters_{};
+    std::vector<Waiter> tick_waiters_{};
+
+    static void wait(std::vector<Waiter>& queue, Waiter waiter);
+    static void resume_due(std::vector<Waiter>& queue, u64 now);
+};
+
+inline auto Scheduler::sleep(time::Duration duration)
+{
+    return Sleep{
+        time_waiters_,
+        now_ns_ + duration.nanosecond_value(),
+        now_ns_,
+    };
+}
+
+inline auto Scheduler::sleep_ticks(u64 count)
+{
+    return Sleep{tick_waiters_, tick_ + count, tick_};
+}
+
+} // namespace engine::tasks
@@ -0,0 +1,173 @@
+#include "timer_wheel.h"
+#include <algorithm>
+
+namespace engine::timers {
+
+namespace {
+
+auto slot_index(u64 tick, u32 level) -> u32
+{
+    constexpr u32 bits = TimerWheel::SLOT_BITS;
+    return static_cast<u32>((tick >> (bits * level)) & (TimerWheel::SLOTS - 1));
+}
+
+} // namespace
+
+TimerWheel::TimerWheel(time::Duration tick_duration) :
+    tick_ns_(std::max<u64>(tick_duration.nanosecond_value(), 1))
+{
+    std::fill(std::begin(slots_), std::end(slots_), NONE);
+}
+
+auto TimerWheel::schedule_ticks(
+    u64 ticks,
+    TimerCallback callback,
+    void* context
+) -> TimerId
+{
+    u32 index = free_;
+    if (index != NONE) {
+        free_ = timers_[index].next;
+    } else {
+        index = static_cast<u32>(timers_.size());
+        timers_.push_back({});
+    }
+
+    Timer& timer = timers_[index];
+    timer.expires = now_ + std::max<u64>(ticks, 1);
+    timer.callback = callback;
+    timer.context = context;
+    link(index);
+    ++pending_;
+    return {index, timer.generation};
+}
+
+auto TimerWheel::schedule(
+    time::Duration delay,
+    TimerCallback callback,
+    void* context
+) -> TimerId
+{
+    return schedule_ticks(to_ticks(delay), callback, context);
+}
+
+auto TimerWheel::cancel(TimerId id) -> bool
+{
+    if (id.index >= timers_.size()) {
+        return false;
+    }
+    Timer& timer = timers_[id.index];
+    if (timer.generation != id.generation || timer.slot == NONE) {
+        return false;
+    }
+
+    unlink(id.index);
+    release(id.index);
+    return true;
+}
+
+void TimerWheel::advance(u64 ticks)
+{
+    for (u64 i = 0; i < ticks; ++i) {
+        tick();
+    }
+
+    // batched dispatch; callbacks only reach the slot lists through
+    // schedule and cancel, never expired_ itself
+    for (const auto& expired : expired_) {
+        expired.callback(expired.context);
+    }
+    expired_.clear();
+}
+
+auto TimerWheel::to_ticks(time::Duration duration) const -> u64
+{
+    return (duration.nanosecond_value() + tick_ns_ - 1) / tick_ns_;
+}
+
+void TimerWheel::link(u32 index)
+{
+    Timer& timer = timers_[index];
+
+    // timers beyond the wheel range wait in the farthest slot and are
+    // placed again when it is cascaded
+    u64 expires = std::min(timer.expires, now_ + RANGE - 1);
+    u64 delta = expires - now_;
+    u32 level = 0;
+    while (level + 1 < LEVELS && (delta >> (SLOT_BITS * (level + 1))) != 0) {
+        ++level;
+    }
+    u32 list = level * SLOTS + slot_index(expires, level);
+
+    timer.slot = list;
+    timer.previous = NONE;
+    timer.next = slots_[list];
+    if (timer.next != NONE) {
+        timers_[timer.next].previous = index;
+    }
+    slots_[list] = index;
+}
+
+void TimerWheel::unlink(u32 index)
+{
+    Timer& timer = timers_[index];
+    if (timer.previous != NONE) {
+        timers_[timer.previous].next = timer.next;
+    } else {
+        slots_[timer.slot] = timer.next;
+    }
+    if (timer.next != NONE) {
+        timers_[timer.next].previous = timer.previous;
+    }
+}
+
+void TimerWheel::release(u32 index)
+{
+    Timer& timer = timers_[index];
+    timer.slot = NONE;
+    ++timer.generation;
+    timer.next = free_;
+    free_ = index;
+    --pending_;
+}
+
+void TimerWheel::cascade(u32 level)
+{
+    u32 list = level * SLOTS + slot_index(now_, level);
+
+    u32 index = slots_[list];
+    slots_[list] = NONE;
+    while (index != NONE) {
+        u32 next = timers_[index].next;
+        link(index);
+        index = next;
+    }
+}
+
+void TimerWheel::tick()
+{
+    ++now_;
+
+    // a slot of level n is redistributed whenever the slot indices of all
+    // levels below it wrap around; higher levels go first so that their
+    // timers can still land in the lower slots being cascaded now
+    u32 top = 0;
+    while (top + 1 < LEVELS && slot_index(now_, top) == 0) {
+        ++top;
+    }
+    for (u32 level = top; level > 0; --level) {
+        cascade(level);
+    }
+
+    u32 list = slot_index(now_, 0);
+    u32 index = slots_[list];
+    slots_[list] = NONE;
+    while (index != NONE) {
+        u32 next = timers_[index].next;
+        expired_.push_back({timers_[index].callback, timers_[index].context});
+        release(index);
+        index = next;
+    }
+}
+
+} // namespace engine::timers
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "core.h"
+#include "time.h"
+#include <vector>
+
+namespace engine::timers {
+
+/**
+ * Handle of a scheduled timer. Handles stay safe to use after the timer
+ * fired or was cancelled; the generation tells them apart from later
+ * timers reusing the same slot.
+ */
+struct TimerId {
+    u32 index;
+    u32 generation;
+};
+
+/** Invoked with the context given when the timer was scheduled. */
+using TimerCallback = void (*)(void* context);
+
+/**
+ * Hierarchical timing wheel keyed by tick.
+ *
+ * Four levels of 64 slots cover 2^24 ticks (about a week at 30 ticks per
+ * second); timers further out are parked in the last slot and re-sorted
+ * when it comes around. A timer lives in a doubly linked slot list, which
+ * makes schedule and cancel O(1). Advancing a tick empties one level 0
+ * slot and, every 64 ticks, redistributes one slot of the level above.
+ *
+ * Expired timers are collected first and their callbacks run as a batch
+ * afterwards, so callbacks may freely schedule or cancel timers.
+ *
+ * A wheel can be copied, e.g. to snapshot game state; assigning to a copy
+ * of similar size reuses its storage.
+ */
+class TimerWheel final {
+public:
+    static constexpr u32 LEVELS = 4;
+    static constexpr u32 SLOT_BITS = 6;
+    static constexpr u32 SLOTS = 1 << SLOT_BITS;
+    static constexpr u64 RANGE = u64{1} << (SLOT_BITS * LEVELS);
+
+    explicit TimerWheel(time::Duration tick_duration);
+    DEFAULT_DTOR(TimerWheel);
+    DEFAULT_COPY(TimerWheel);
+    DEFAULT_MOVE(TimerWheel);
+
+    /**
+     * Fires `callback` after `ticks` ticks. Zero is treated as one since
+     * the current tick has already been processed.
+     */
+    auto schedule_ticks(u64 ticks, TimerCallback callback, void* context)
+        -> TimerId;
+
+    /** Fires `callback` once `delay` has passed, rounded up to ticks. */
+    auto schedule(time::Duration delay, TimerCallback callback, void* context)
+        -> TimerId;
+
+    /**
+     * Returns false if the timer already fired or was cancelled. Timers
+     * expiring in the same advance are already collected, so cancelling
+     * one of them from a callback of that batch does not stop it.
+     */
+    auto cancel(TimerId id) -> bool;
+
+    /** Advances by `ticks` ticks and runs the callbacks of due timers. */
+    void advance(u64 ticks = 1);
+
+    /** Number of ticks `duration` spans, rounded up. */
+    [[nodiscard]] auto to_ticks(time::Duration duration) const -> u64;
+
+    [[nodiscard]] auto now() const -> u64 { return now_; }
+    [[nodiscard]] auto pending() const -> u32 { return pending_; }
+
+    /** Calls `visit(context)` for every pending timer. */
+    template <typename Visit>
+    void for_each_pending(Visit&& visit) const
+    {
+        for (const auto& timer : timers_) {
+            if (timer.slot != NONE) {
+                visit(timer.context);
+            }
+        }
+    }
+
+private:
+    static constexpr u32 NONE = ~u32{0};
+
+    struct Timer {
+        u64 expires;
+        TimerCallback callback;
+        void* context;
+        u32 next;
+        u32 previous;
+        // index into slots_ or NONE when the timer is free
+        u32 slot;
+        u32 generation;
+    };
+
+    struct Expired {
+        TimerCallback callback;
+        void* context;
+    };
+
+    u64 tick_ns_;
+    u64 now_{0};
+    u32 pending_{0};
+    u32 free_{NONE};
+    std::vector<Timer> timers_{};
+    std::vector<Expired> expired_{};
+    u32 slots_[LEVELS * SLOTS];
+
+    void link(u32 index);
+    void unlink(u32 index);
+    void release(u32 index);
+    void cascade(u32 level);
+    void tick();
+};
+
+} // namespace engine::timers
@@ -0,0 +1,271 @@
+#include "upscaler.h"
+#include "simd.h"
+#include <cstring>
+
+namespace engine::graphics {
+
+namespace {
+
+inline auto lerp_pixel(ARGB a, ARGB b, u32 weight) -> ARGB
+{
+    ARGB result{};
+    for (u32 i = 0; i < 4; ++i) {
+        u32 value = (a.data[i] * (256 - weight) + b.data[i] * weight) >> 8;
+        result.data[i] = static_cast<u8>(value);
+    }
+    return result;
+}
+
+/**
+ * Vertically blends two source rows into the scratch row.
+ */
+void blend_rows(
+    const ARGB* top,
+    const ARGB* bottom,
+    ARGB* target,
+    s32 width,
+    u32 weight
+)
+{
+    s32 x = 0;
+
+#if defined(ENGINE_SIMD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i top_weight = _mm_set1_epi16(static_cast<s16>(256 - weight));
+    const __m128i bottom_weight = _mm_set1_epi16(static_cast<s16>(weight));
+
+    for (; x + 4 <= width; x += 4) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + x));
+        __m128i b =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + x));
+
+        __m128i lo = _mm_add_epi16(
+            _mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), top_weight),
+            _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), bottom_weight)
+        );
+        __m128i hi = _mm_add_epi16(
+            _mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), top_weight),
+            _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), bottom_weight)
+        );
+
+        __m128i blended =
+            _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(target + x), blended);
+    }
+#endif
+
+    for (; x < width; ++x) {
+        target[x] = lerp_pixel(top[x], bottom[x], weight);
+    }
+}
+
+} // namespace
+
+//===========================================================================
+// Upscaler
+//===========================================================================
+
+void Upscaler::upscale(
+    const ScreenBuffer& source,
+    ScreenBuffer& target,
+    ScaleFilter filter
+)
+{
+    if (source.width != source_width_ || source.height != source_height_ ||
+        target.width != target_width_ || target.height != target_height_) {
+        prepare(source, target);
+    }
+
+    switch (filter) {
+        case ScaleFilter::NEAREST:
+            upscale_nearest(source, target);
+            break;
+        case ScaleFilter::BILINEAR:
+            upscale_bilinear(source, target);
+            break;
+    }
+}
+
+/**
+ * Maps target coordinates to source coordinates with pixel centers aligned.
+ * The fractional part becomes the weight of the next source sample.
+ */
+void Upscaler::build_samples(
+    std::vector<Sample>& samples,
+    std::vector<s32>& nearest,
+    s32 source_size,
+    s32 target_size
+)
+{
+    samples.resize(static_cast<u64>(target_size));
+    nearest.resize(static_cast<u64>(target_size));
+
+    s64 last = source_size - 1;
+
+    for (u64 i = 0; i < samples.size(); ++i) {
+        // center of the target pixel in source space, 16.16 fixed point;
+        // computed directly rather than accumulated to avoid drift
+        s64 center = static_cast<s64>(2 * i + 1) * (s64{source_size} << 16) /
+                     (2 * s64{target_size});
+        s64 position = center - (1 << 15);
+        s64 clamped = position < 0 ? 0 : position;
+        s64 index = clamped >> 16;
+        s64 weight = (clamped >> 8) & 0xff;
+        if (index >= last) {
+            // keep index + 1 inside the source; all weight on the last one
+            index = last > 0 ? last - 1 : 0;
+            weight = last > 0 ? 256 : 0;
+        }
+
+        samples[i] = {static_cast<u32>(index), static_cast<u32>(weight)};
+        nearest[i] = static_cast<s32>(weight >= 128 ? index + 1 : index);
+    }
+}
+
+void Upscaler::prepare(const ScreenBuffer& source, const ScreenBuffer& target)
+{
+    source_width_ = source.width;
+    source_height_ = source.height;
+    target_width_ = target.width;
+    target_height_ = target.height;
+
+    build_samples(columns_, nearest_columns_, source.width, target.width);
+    build_samples(rows_, nearest_rows_, source.height, target.height);
+    scratch_row_.resize(static_cast<u64>(source.width));
+}
+
+void Upscaler::upscale_nearest(const ScreenBuffer& source, ScreenBuffer& target)
+{
+    u64 row_bytes = static_cast<u64>(target.width) * sizeof(ARGB);
+    const s32* columns = nearest_columns_.data();
+
+    const ARGB* previous_source_row = nullptr;
+    const ARGB* previous_target_row = nullptr;
+
+    for (s32 y = 0; y < target.height; ++y) {
+        s32 source_y = nearest_rows_[static_cast<u64>(y)];
+        const ARGB* source_row =
+            source.pixels + static_cast<s64>(source_y) * source.width;
+        ARGB* target_row = target.pixels + static_cast<s64>(y) * target.width;
+
+        // upscaling repeats source rows; copy the finished target row instead
+        // of resampling it again
+        if (source_row == previous_source_row) {
+            std::memcpy(target_row, previous_target_row, row_bytes);
+            continue;
+        }
+        previous_source_row = source_row;
+        previous_target_row = target_row;
+
+        s32 x = 0;
+#if defined(ENGINE_SIMD_AVX2)
+        for (; x + 8 <= target.width; x += 8) {
+            __m256i indices = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(columns + x)
+            );
+            __m256i pixels = _mm256_i32gather_epi32(
+                reinterpret_cast<const int*>(source_row),
+                indices,
+                4
+            );
+            _mm256_storeu_si256(
+                reinterpret_cast<__m256i*>(target_row + x),
+                pixels
+            );
+        }
+#elif defined(ENGINE_SIMD_SSE2)
+        if (target.width == source.width * 2) {
+            // the common half resolution case needs no lookups at all
+            for (; x + 8 <= target.width; x += 8) {
+                __m128i pixels = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(source_row + x / 2)
+                );
+                auto* out = reinterpret_cast<__m128i*>(target_row + x);
+                _mm_storeu_si128(out, _mm_unpacklo_epi32(pixels, pixels));
+                _mm_storeu_si128(out + 1, _mm_unpackhi_epi32(pixels, pixels));
+            }
+        }
+#endif
+
+        for (; x < target.width; ++x) {
+            target_row[x] = source_row[columns[x]];
+        }
+    }
+}
+
+void Upscaler::upscale_bilinear(
+    const ScreenBuffer& source,
+    ScreenBuffer& target
+)
+{
+    ARGB* scratch = scratch_row_.data();
+
+    for (s32 y = 0; y < target.height; ++y) {
+        const auto& row = rows_[static_cast<u64>(y)];
+        const ARGB* top =
+            source.pixels + static_cast<s64>(row.index) * source.width;
+        const ARGB* bottom = source.height > 1 ? top + source.width : top;
+        blend_rows(top, bottom, scratch, source.width, row.weight);
+
+        ARGB* target_row = target.pixels + static_cast<s64>(y) * target.width;
+
+        s32 x = 0;
+#if defined(ENGINE_SIMD_SSE2)
+        // build_samples() keeps index + 1 inside the row when width >= 2
+        const __m128i zero = _mm_setzero_si128();
+        s32 simd_width = source.width >= 2 ? target.width : 0;
+        for (; x + 2 <= simd_width; x += 2) {
+            const auto& c0 = columns_[static_cast<u64>(x)];
+            const auto& c1 = columns_[static_cast<u64>(x) + 1];
+
+            // load both neighbour pairs: [a0 a1] and [b0 b1]
+            __m128i a16 = _mm_unpacklo_epi8(
+                _mm_loadl_epi64(
+                    reinterpret_cast<const __m128i*>(scratch + c0.index)
+                ),
+                zero
+            );
+            __m128i b16 = _mm_unpacklo_epi8(
+                _mm_loadl_epi64(
+                    reinterpret_cast<const __m128i*>(scratch + c1.index)
+                ),
+                zero
+            );
+
+            auto wa = static_cast<s16>(c0.weight);
+            auto wb = static_cast<s16>(c1.weight);
+            auto ia = static_cast<s16>(256 - c0.weight);
+            auto ib = static_cast<s16>(256 - c1.weight);
+            a16 = _mm_mullo_epi16(
+                a16,
+                _mm_setr_epi16(ia, ia, ia, ia, wa, wa, wa, wa)
+            );
+            b16 = _mm_mullo_epi16(
+                b16,
+                _mm_setr_epi16(ib, ib, ib, ib, wb, wb, wb, wb)
+            );
+
+            // sum the pair halves; each result lands in the low 4 lanes
+            __m128i sum_a = _mm_add_epi16(a16, _mm_srli_si128(a16, 8));
+            __m128i sum_b = _mm_add_epi16(b16, _mm_srli_si128(b16, 8));
+            __m128i result = _mm_unpacklo_epi64(
+                _mm_srli_epi16(sum_a, 8),
+                _mm_srli_epi16(sum_b, 8)
+            );
+            _mm_storel_epi64(
+                reinterpret_cast<__m128i*>(target_row + x),
+                _mm_packus_epi16(result, result)
+            );
+        }
+#endif
+
+        for (; x < target.width; ++x) {
+            const auto& column = columns_[static_cast<u64>(x)];
+            const ARGB* left = scratch + column.index;
+            const ARGB* right = source.width > 1 ? left + 1 : left;
+            target_row[x] = lerp_pixel(*left, *right, column.weight);
+        }
+    }
+}
+
+} // namespace engine::graphics
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "core.h"
+#include "graphics.h"
+#include <vector>
+
+namespace engine::graphics {
+
+enum ScaleFilter {
+    NEAREST,
+    BILINEAR,
+};
+
+//===========================================================================
+// Upscaler
+//===========================================================================
+
+/**
+ * Scales a (smaller) internal render target up to the output resolution.
+ *
+ * The per-column and per-row source coordinates and filter weights are
+ * computed once per source/target size pair and reused every frame, so the
+ * per-frame work is just the SIMD resampling itself.
+ */
+class Upscaler final {
+public:
+    DEFAULT_CTOR(Upscaler);
+    DEFAULT_DTOR(Upscaler);
+    DELETE_COPY(Upscaler);
+    DEFAULT_MOVE(Upscaler);
+
+    void upscale(
+        const ScreenBuffer& source,
+        ScreenBuffer& target,
+        ScaleFilter filter
+    );
+
+private:
+    struct Sample {
+        u32 index;
+        // weight of the sample at index + 1 in 1/256 units
+        u32 weight;
+    };
+
+    static void build_samples(
+        std::vector<Sample>& samples,
+        std::vector<s32>& nearest,
+        s32 source_size,
+        s32 target_size
+    );
+
+    void prepare(const ScreenBuffer& source, const ScreenBuffer& target);
+    void upscale_nearest(const ScreenBuffer& source, ScreenBuffer& target);
+    void upscale_bilinear(const ScreenBuffer& source, ScreenBuffer& target);
+
+    s32 source_width_{0};
+    s32 source_height_{0};
+    s32 target_width_{0};
+    s32 target_height_{0};
+
+    std::vector<Sample> columns_{};
+    std::vector<Sample> rows_{};
+    std::vector<s32> nearest_columns_{};
+    std::vector<s32> nearest_rows_{};
+    std::vector<ARGB> scratch_row_{};
+};
+
+} // namespace engine::graphics
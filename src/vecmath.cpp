@@ -0,0 +1,96 @@
+#include "vecmath.h"
+#include "simd.h"
+
+namespace engine::math {
+
+void transform_points(
+    const mat2x3& m,
+    const f32* xs,
+    const f32* ys,
+    f32* out_xs,
+    f32* out_ys,
+    u32 count
+)
+{
+    u32 i = 0;
+
+#if defined(ENGINE_SIMD_SSE2)
+    const __m128 m00 = _mm_set1_ps(m.m00);
+    const __m128 m01 = _mm_set1_ps(m.m01);
+    const __m128 m02 = _mm_set1_ps(m.m02);
+    const __m128 m10 = _mm_set1_ps(m.m10);
+    const __m128 m11 = _mm_set1_ps(m.m11);
+    const __m128 m12 = _mm_set1_ps(m.m12);
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(xs + i);
+        __m128 y = _mm_loadu_ps(ys + i);
+        __m128 tx = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m01, y)),
+            m02
+        );
+        __m128 ty = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(m10, x), _mm_mul_ps(m11, y)),
+            m12
+        );
+        _mm_storeu_ps(out_xs + i, tx);
+        _mm_storeu_ps(out_ys + i, ty);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        auto p = transform_point(m, {xs[i], ys[i]});
+        out_xs[i] = p.x;
+        out_ys[i] = p.y;
+    }
+}
+
+void dot_products(
+    const f32* ax,
+    const f32* ay,
+    const f32* bx,
+    const f32* by,
+    f32* out,
+    u32 count
+)
+{
+    u32 i = 0;
+
+#if defined(ENGINE_SIMD_SSE2)
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_mul_ps(_mm_loadu_ps(ax + i), _mm_loadu_ps(bx + i));
+        __m128 y = _mm_mul_ps(_mm_loadu_ps(ay + i), _mm_loadu_ps(by + i));
+        _mm_storeu_ps(out + i, _mm_add_ps(x, y));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        out[i] = dot({ax[i], ay[i]}, {bx[i], by[i]});
+    }
+}
+
+void cross_products(
+    const f32* ax,
+    const f32* ay,
+    const f32* bx,
+    const f32* by,
+    f32* out,
+    u32 count
+)
+{
+    u32 i = 0;
+
+#if defined(ENGINE_SIMD_SSE2)
+    for (; i + 4 <= count; i += 4) {
+        __m128 xy = _mm_mul_ps(_mm_loadu_ps(ax + i), _mm_loadu_ps(by + i));
+        __m128 yx = _mm_mul_ps(_mm_loadu_ps(ay + i), _mm_loadu_ps(bx + i));
+        _mm_storeu_ps(out + i, _mm_sub_ps(xy, yx));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        out[i] = cross({ax[i], ay[i]}, {bx[i], by[i]});
+    }
+}
+
+} // namespace engine::math
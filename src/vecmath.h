@@ -0,0 +1,269 @@
+#pragma once
+
+#include "core.h"
+#include <cmath>
+#include <numbers>
+
+//
+// Small 2D math library. Scalar types and operations are constexpr; the
+// batched variants at the bottom work on structure-of-arrays data and are
+// vectorized.
+//
+
+namespace engine::math {
+
+constexpr f32 PI = std::numbers::pi_v<f32>;
+constexpr f32 TWO_PI = 2.0f * PI;
+
+//===========================================================================
+// Scalar helpers
+//===========================================================================
+
+/**
+ * Sine usable in constant expressions; falls back to std::sin at run time.
+ */
+constexpr auto sin(f32 radians) -> f32
+{
+    if consteval {
+        // reduce to [-pi, pi] and evaluate the Taylor series, which is
+        // accurate to ~1e-7 over that range with this many terms
+        f64 x = radians;
+        x -= static_cast<f64>(static_cast<s64>(x / TWO_PI)) * TWO_PI;
+        if (x > PI) {
+            x -= TWO_PI;
+        } else if (x < -PI) {
+            x += TWO_PI;
+        }
+        f64 term = x;
+        f64 sum = x;
+        for (s32 i = 1; i < 12; ++i) {
+            term *= -x * x / ((2 * i) * (2 * i + 1));
+            sum += term;
+        }
+        return static_cast<f32>(sum);
+    } else {
+        return std::sin(radians);
+    }
+}
+
+/**
+ * Cosine usable in constant expressions; falls back to std::cos at run time.
+ */
+constexpr auto cos(f32 radians) -> f32
+{
+    if consteval {
+        return sin(radians + PI / 2.0f);
+    } else {
+        return std::cos(radians);
+    }
+}
+
+//===========================================================================
+// vec2
+//===========================================================================
+
+struct vec2 {
+    f32 x;
+    f32 y;
+
+    constexpr auto operator+=(vec2 other) -> vec2&
+    {
+        x += other.x;
+        y += other.y;
+        return *this;
+    }
+
+    constexpr auto operator-=(vec2 other) -> vec2&
+    {
+        x -= other.x;
+        y -= other.y;
+        return *this;
+    }
+
+    constexpr auto operator*=(f32 scalar) -> vec2&
+    {
+        x *= scalar;
+        y *= scalar;
+        return *this;
+    }
+
+    friend constexpr auto operator==(vec2 lhs, vec2 rhs) -> bool = default;
+};
+
+constexpr auto operator+(vec2 lhs, vec2 rhs) -> vec2
+{
+    return {lhs.x + rhs.x, lhs.y + rhs.y};
+}
+
+constexpr auto operator-(vec2 lhs, vec2 rhs) -> vec2
+{
+    return {lhs.x - rhs.x, lhs.y - rhs.y};
+}
+
+constexpr auto operator-(vec2 v) -> vec2
+{
+    return {-v.x, -v.y};
+}
+
+constexpr auto operator*(vec2 v, f32 scalar) -> vec2
+{
+    return {v.x * scalar, v.y * scalar};
+}
+
+constexpr auto operator*(f32 scalar, vec2 v) -> vec2
+{
+    return {v.x * scalar, v.y * scalar};
+}
+
+constexpr auto dot(vec2 a, vec2 b) -> f32
+{
+    return a.x * b.x + a.y * b.y;
+}
+
+/** Z component of the 3D cross product; positive if b is ccw from a. */
+constexpr auto cross(vec2 a, vec2 b) -> f32
+{
+    return a.x * b.y - a.y * b.x;
+}
+
+constexpr auto length_squared(vec2 v) -> f32
+{
+    return dot(v, v);
+}
+
+inline auto length(vec2 v) -> f32
+{
+    return std::sqrt(length_squared(v));
+}
+
+/** Vector rotated by 90 degrees counter-clockwise. */
+constexpr auto perpendicular(vec2 v) -> vec2
+{
+    return {-v.y, v.x};
+}
+
+/** Unit vector pointing at the given angle. */
+constexpr auto from_angle(f32 radians) -> vec2
+{
+    return {cos(radians), sin(radians)};
+}
+
+//===========================================================================
+// mat2x3
+//===========================================================================
+
+/**
+ * 2D affine transform; a 2x2 linear part plus a translation column:
+ *
+ *   | m00 m01 m02 |   | x |
+ *   | m10 m11 m12 | * | y |
+ *                     | 1 |
+ */
+struct mat2x3 {
+    f32 m00;
+    f32 m01;
+    f32 m02;
+    f32 m10;
+    f32 m11;
+    f32 m12;
+
+    static constexpr auto identity() -> mat2x3
+    {
+        return {1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f};
+    }
+
+    static constexpr auto translation(vec2 offset) -> mat2x3
+    {
+        return {1.0f, 0.0f, offset.x, 0.0f, 1.0f, offset.y};
+    }
+
+    static constexpr auto rotation(f32 radians) -> mat2x3
+    {
+        f32 s = sin(radians);
+        f32 c = cos(radians);
+        return {c, -s, 0.0f, s, c, 0.0f};
+    }
+
+    static constexpr auto scale(f32 factor) -> mat2x3
+    {
+        return {factor, 0.0f, 0.0f, 0.0f, factor, 0.0f};
+    }
+
+    /**
+     * Scale, then rotate, then translate; the usual object-to-world matrix.
+     */
+    static constexpr auto from_transform(vec2 position, f32 radians, f32 factor)
+        -> mat2x3
+    {
+        f32 s = sin(radians) * factor;
+        f32 c = cos(radians) * factor;
+        return {c, -s, position.x, s, c, position.y};
+    }
+
+    friend constexpr auto operator==(const mat2x3& lhs, const mat2x3& rhs)
+        -> bool = default;
+};
+
+/** Composition; (a * b) applies b first. */
+constexpr auto operator*(const mat2x3& a, const mat2x3& b) -> mat2x3
+{
+    return {
+        a.m00 * b.m00 + a.m01 * b.m10,
+        a.m00 * b.m01 + a.m01 * b.m11,
+        a.m00 * b.m02 + a.m01 * b.m12 + a.m02,
+        a.m10 * b.m00 + a.m11 * b.m10,
+        a.m10 * b.m01 + a.m11 * b.m11,
+        a.m10 * b.m02 + a.m11 * b.m12 + a.m12,
+    };
+}
+
+constexpr auto transform_point(const mat2x3& m, vec2 p) -> vec2
+{
+    return {
+        m.m00 * p.x + m.m01 * p.y + m.m02,
+        m.m10 * p.x + m.m11 * p.y + m.m12,
+    };
+}
+
+/** Transforms a direction; the translation is ignored. */
+constexpr auto transform_vector(const mat2x3& m, vec2 v) -> vec2
+{
+    return {m.m00 * v.x + m.m01 * v.y, m.m10 * v.x + m.m11 * v.y};
+}
+
+//===========================================================================
+// Batched operations on SoA data
+//===========================================================================
+//
+// All arrays hold `count` elements. Output arrays may alias the matching
+// input arrays (e.g. transforming points in place).
+//
+
+void transform_points(
+    const mat2x3& m,
+    const f32* xs,
+    const f32* ys,
+    f32* out_xs,
+    f32* out_ys,
+    u32 count
+);
+
+void dot_products(
+    const f32* ax,
+    const f32* ay,
+    const f32* bx,
+    const f32* by,
+    f32* out,
+    u32 count
+);
+
+void cross_products(
+    const f32* ax,
+    const f32* ay,
+    const f32* bx,
+    const f32* by,
+    f32* out,
+    u32 count
+);
+
+} // namespace engine::math
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "core.h"
+
+//
+// Toroidal world helpers. Everything that moves lives on a torus of the size
+// of the world: leaving one edge means re-entering from the opposite one.
+// All functions are branch-free so that they can be used inside vectorized
+// update loops.
+//
+
+namespace engine::world {
+
+struct WorldBounds {
+    s32 width;
+    s32 height;
+};
+
+/**
+ * Wraps any coordinate into [0, size).
+ */
+constexpr auto wrap(s32 value, s32 size) -> s32
+{
+    s32 remainder = value % size;
+    return remainder + (size & -static_cast<s32>(remainder < 0));
+}
+
+/**
+ * Wraps a coordinate in [-size, 2 * size) into [0, size) without division;
+ * the common case of an object that moved at most one world per tick.
+ */
+constexpr auto wrap_near(s32 value, s32 size) -> s32
+{
+    value += size & -static_cast<s32>(value < 0);
+    value -= size & -static_cast<s32>(value >= size);
+    return value;
+}
+
+/**
+ * Floating point variant of wrap_near() for sub-pixel positions.
+ */
+constexpr auto wrap_near(f32 value, f32 size) -> f32
+{
+    value += value < 0.0f ? size : 0.0f;
+    value -= value >= size ? size : 0.0f;
+    return value;
+}
+
+/**
+ * Shortest signed displacement from `from` to `to` on a ring of `size`;
+ * the result is in [-size / 2, size / 2).
+ */
+constexpr auto wrapped_delta(s32 from, s32 to, s32 size) -> s32
+{
+    s32 half = size / 2;
+    return wrap(to - from + half, size) - half;
+}
+
+constexpr auto wrapped_distance_squared(
+    s32 x0,
+    s32 y0,
+    s32 x1,
+    s32 y1,
+    WorldBounds bounds
+) -> s64
+{
+    s64 dx = wrapped_delta(x0, x1, bounds.width);
+    s64 dy = wrapped_delta(y0, y1, bounds.height);
+    return dx * dx + dy * dy;
+}
+
+/**
+ * Circle overlap test that also finds hits across the seams.
+ */
+constexpr auto circles_overlap(
+    s32 x0,
+    s32 y0,
+    s32 radius0,
+    s32 x1,
+    s32 y1,
+    s32 radius1,
+    WorldBounds bounds
+) -> bool
+{
+    s64 reach = s64{radius0} + s64{radius1};
+    return wrapped_distance_squared(x0, y0, x1, y1, bounds) <= reach * reach;
+}
+
+/**
+ * Invokes `draw(x, y)` for every position an object must be drawn at so
+ * that the parts straddling an edge show up on the opposite side too. That
+ * is the object itself plus up to three shifted copies (in a corner).
+ */
+template <typename DrawFunction>
+void for_each_image(
+    s32 x,
+    s32 y,
+    s32 radius,
+    WorldBounds bounds,
+    DrawFunction&& draw
+)
+{
+    s32 shift_x = 0;
+    if (x - radius < 0) {
+        shift_x = bounds.width;
+    } else if (x + radius >= bounds.width) {
+        shift_x = -bounds.width;
+    }
+
+    s32 shift_y = 0;
+    if (y - radius < 0) {
+        shift_y = bounds.height;
+    } else if (y + radius >= bounds.height) {
+        shift_y = -bounds.height;
+    }
+
+    draw(x, y);
+    if (shift_x != 0) {
+        draw(x + shift_x, y);
+    }
+    if (shift_y != 0) {
+        draw(x, y + shift_y);
+    }
+    if (shift_x != 0 && shift_y != 0) {
+        draw(x + shift_x, y + shift_y);
+    }
+}
+
+} // namespace engine::world
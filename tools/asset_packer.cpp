@@ -0,0 +1,204 @@
+//
+// Builds a packed asset archive (see AssetArchive) from a manifest, so that
+// the game maps its content at startup instead of parsing loose files. Any
+// conversion from source formats happens here, once.
+//
+// Every manifest line names one asset: "<type> <name> <path>", the path
+// being relative to the manifest; '#' starts a comment. Types:
+//
+//   raw      the file as it is
+//   mesh     whitespace separated "x y" vertex coordinates
+//   palette  whitespace separated "rrggbb" hex colors
+//
+// usage: asset_packer <manifest> <archive>
+//        asset_packer --list <archive>
+//
+
+#include "../src/asset_archive.h"
+#include "../src/core.h"
+#include "../src/graphics.h"
+#include "../src/vecmath.h"
+#include <charconv>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <print>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using engine::assets::AssetType;
+
+namespace {
+
+auto read_file(const std::filesystem::path& path, std::string& contents)
+    -> bool
+{
+    std::ifstream file{path, std::ios::binary};
+    if (!file) {
+        return false;
+    }
+    std::ostringstream stream{};
+    stream << file.rdbuf();
+    contents = std::move(stream).str();
+    return true;
+}
+
+template <typename T>
+auto as_bytes(const std::vector<T>& values) -> std::span<const u8>
+{
+    return {
+        reinterpret_cast<const u8*>(values.data()),
+        values.size() * sizeof(T),
+    };
+}
+
+auto parse_mesh(const std::string& text, std::vector<u8>& bytes) -> bool
+{
+    std::istringstream stream{text};
+    std::vector<engine::math::vec2> vertices{};
+    f32 x = 0.0f;
+    f32 y = 0.0f;
+    while (stream >> x >> y) {
+        vertices.push_back({x, y});
+    }
+    if (!stream.eof() || vertices.size() < 3) {
+        return false;
+    }
+    auto view = as_bytes(vertices);
+    bytes.assign(view.begin(), view.end());
+    return true;
+}
+
+auto parse_palette(const std::string& text, std::vector<u8>& bytes) -> bool
+{
+    std::istringstream stream{text};
+    std::vector<engine::graphics::ARGB> colors{};
+    std::string token{};
+    while (stream >> token) {
+        u32 rgb = 0;
+        auto [end, error] = std::from_chars(
+            token.data(),
+            token.data() + token.size(),
+            rgb,
+            16
+        );
+        if (error != std::errc{} || end != token.data() + token.size() ||
+            token.size() != 6) {
+            return false;
+        }
+        colors.push_back(engine::graphics::argb_create(
+            static_cast<u8>(rgb >> 16),
+            static_cast<u8>(rgb >> 8),
+            static_cast<u8>(rgb)
+        ));
+    }
+    auto view = as_bytes(colors);
+    bytes.assign(view.begin(), view.end());
+    return true;
+}
+
+auto pack(const char* manifest_path, const char* archive_path) -> int
+{
+    std::string manifest{};
+    if (!read_file(manifest_path, manifest)) {
+        std::println("cannot read manifest '{}'", manifest_path);
+        return 1;
+    }
+    auto directory = std::filesystem::path{manifest_path}.parent_path();
+    auto fail = [&](u32 line_number, std::string_view message) {
+        std::println("{}:{}: {}", manifest_path, line_number, message);
+        return 1;
+    };
+
+    engine::assets::ArchiveBuilder builder{};
+    std::istringstream lines{manifest};
+    std::string line{};
+    for (u32 number = 1; std::getline(lines, line); ++number) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields{line};
+        std::string type{};
+        std::string name{};
+        std::string path{};
+        if (!(fields >> type)) {
+            continue;
+        }
+        if (!(fields >> name >> path)) {
+            return fail(number, "expected <type> <name> <path>");
+        }
+
+        std::string contents{};
+        if (!read_file(directory / path, contents)) {
+            return fail(number, std::format("cannot read '{}'", path));
+        }
+
+        std::vector<u8> bytes{};
+        AssetType asset_type = engine::assets::ASSET_RAW;
+        bool converted = true;
+        if (type == "raw") {
+            bytes.assign(contents.begin(), contents.end());
+        } else if (type == "mesh") {
+            asset_type = engine::assets::ASSET_MESH;
+            converted = parse_mesh(contents, bytes);
+        } else if (type == "palette") {
+            asset_type = engine::assets::ASSET_PALETTE;
+            converted = parse_palette(contents, bytes);
+        } else {
+            return fail(number, std::format("unknown type '{}'", type));
+        }
+        if (!converted) {
+            return fail(number, std::format("malformed {} '{}'", type, path));
+        }
+        if (!builder.add(name, asset_type, bytes)) {
+            return fail(number, std::format("duplicate name '{}'", name));
+        }
+    }
+
+    if (!builder.write(archive_path)) {
+        std::println("cannot write '{}'", archive_path);
+        return 1;
+    }
+    std::println("{}: {} assets", archive_path, builder.asset_count());
+    return 0;
+}
+
+auto list(const char* archive_path) -> int
+{
+    engine::assets::AssetArchive archive{};
+    if (!archive.open(archive_path)) {
+        std::println("'{}' is not an asset archive", archive_path);
+        return 1;
+    }
+
+    constexpr const char* TYPE_NAMES[] = {"raw", "mesh", "palette"};
+    for (const auto& entry : archive.entries()) {
+        auto type = entry.type < std::size(TYPE_NAMES) ?
+                        TYPE_NAMES[entry.type] :
+                        "?";
+        std::println(
+            "{:>10} {:>8} {:<8} {}",
+            entry.offset,
+            entry.size,
+            type,
+            archive.name(entry)
+        );
+    }
+    return 0;
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int
+{
+    if (argc == 3 && std::string_view{argv[1]} == "--list") {
+        return list(argv[2]);
+    }
+    if (argc == 3) {
+        return pack(argv[1], argv[2]);
+    }
+
+    std::println("usage: asset_packer <manifest> <archive>");
+    std::println("       asset_packer --list <archive>");
+    return 1;
+}
@@ -0,0 +1,105 @@
+//
+// Measures how long the software mixer takes per 10 ms block with every
+// voice busy, which is the worst case the game can produce. The blocks are
+// mixed back to back without a sink, so only the mixing itself is timed.
+//
+// usage: audio_bench [blocks]
+//
+
+#include "../src/audio_mixer.h"
+#include "../src/core.h"
+#include "../src/metrics.h"
+#include "../src/time.h"
+#include <charconv>
+#include <cmath>
+#include <print>
+#include <string_view>
+#include <vector>
+
+using engine::audio::AudioMixer;
+using engine::audio::VoiceMixer;
+
+namespace {
+
+constexpr u32 DEFAULT_BLOCKS = 6000;
+constexpr u32 SOUND_COUNT = 16;
+
+/**
+ * Decaying tones of different lengths, so that the voices wrap around at
+ * different points of a block.
+ */
+auto make_sounds() -> std::vector<std::vector<s16>>
+{
+    std::vector<std::vector<s16>> sounds(SOUND_COUNT);
+    for (u32 i = 0; i < SOUND_COUNT; ++i) {
+        u32 length = AudioMixer::SAMPLE_RATE / 4 + i * 997;
+        f32 step = 0.01f + 0.003f * static_cast<f32>(i);
+        sounds[i].resize(length);
+        for (u32 n = 0; n < length; ++n) {
+            f32 t = static_cast<f32>(n);
+            f32 decay = 1.0f - t / static_cast<f32>(length);
+            sounds[i][n] =
+                static_cast<s16>(std::sin(t * step) * decay * 20000.0f);
+        }
+    }
+    return sounds;
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int
+{
+    u32 blocks = DEFAULT_BLOCKS;
+    if (argc == 2) {
+        std::string_view arg{argv[1]};
+        auto [end, error] =
+            std::from_chars(arg.data(), arg.data() + arg.size(), blocks);
+        if (error != std::errc{} || end != arg.data() + arg.size() ||
+            blocks == 0) {
+            std::println("usage: audio_bench [blocks]");
+            return 1;
+        }
+    } else if (argc > 2) {
+        std::println("usage: audio_bench [blocks]");
+        return 1;
+    }
+
+    auto sounds = make_sounds();
+    static VoiceMixer mixer{};
+    for (u32 voice = 0; voice < VoiceMixer::MAX_VOICES; ++voice) {
+        const auto& sound = sounds[voice % SOUND_COUNT];
+        f32 pan = static_cast<f32>(voice % 9) / 4.0f - 1.0f;
+        mixer.play(voice + 1, {sound}, 0.1f, pan, true);
+    }
+
+    std::vector<s16> block(AudioMixer::BLOCK_FRAMES * 2);
+    engine::metrics::Histogram mix_time{};
+    for (u32 i = 0; i < blocks; ++i) {
+        auto start = engine::time::Instant::now();
+        mixer.mix(block);
+        mix_time.record(engine::time::Duration::from(start));
+    }
+
+    auto summary = mix_time.summary();
+    constexpr u64 BLOCK_NS = 10'000'000;
+    std::println(
+        "{} blocks of {} frames, {} voices",
+        blocks,
+        AudioMixer::BLOCK_FRAMES,
+        mixer.active_voices()
+    );
+    std::println(
+        "mix time ns: min {} mean {} p50 {} p99 {} p999 {} max {}",
+        summary.min,
+        summary.mean,
+        summary.p50,
+        summary.p99,
+        summary.p999,
+        summary.max
+    );
+    std::println(
+        "mean load: {:.2f}% of the block period",
+        100.0 * static_cast<f64>(summary.mean) / static_cast<f64>(BLOCK_NS)
+    );
+    return 0;
+}
@@ -0,0 +1,314 @@
+//
+// Checks NarrowPhase against the brute force polygon test and measures its
+// throughput.
+//
+// Random convex hulls are scattered over a small wrapping world, mixed with
+// hand-made touching, containing and degenerate shapes, and some are
+// placed right on the world seams. Every candidate pair goes through
+// NarrowPhase::run; the hits must be exactly the pairs for which
+// polygons_overlap_reference() reports an overlap. After that the same
+// candidates are run repeatedly and pairs per second are reported.
+//
+// usage: collision_bench [runs]
+//
+
+#include "../src/collision.h"
+#include "../src/core.h"
+#include "../src/time.h"
+#include "../src/vecmath.h"
+#include "../src/world.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <iterator>
+#include <print>
+#include <random>
+#include <span>
+#include <string_view>
+#include <vector>
+
+using engine::collision::Collider;
+using engine::collision::CollisionPair;
+using engine::math::vec2;
+
+namespace {
+
+constexpr u32 DEFAULT_RUNS = 50;
+constexpr engine::world::WorldBounds WORLD{512, 384};
+constexpr u32 RANDOM_SHAPES = 1500;
+constexpr u32 CANDIDATES = 200000;
+
+/** Shapes in world space, stored like the game stores its colliders. */
+struct Scene {
+    std::vector<f32> xs;
+    std::vector<f32> ys;
+    std::vector<u32> first_vertex;
+    std::vector<Collider> colliders;
+
+    void add(std::span<const vec2> outline)
+    {
+        vec2 center{0.0f, 0.0f};
+        for (auto point : outline) {
+            center += point;
+        }
+        center *= 1.0f / static_cast<f32>(std::max<u64>(outline.size(), 1));
+
+        f32 radius = 0.0f;
+        first_vertex.push_back(static_cast<u32>(xs.size()));
+        for (auto point : outline) {
+            xs.push_back(point.x);
+            ys.push_back(point.y);
+            radius = std::max(radius, engine::math::length(point - center));
+        }
+        auto count = static_cast<u32>(outline.size());
+        colliders.push_back({center, radius, {nullptr, nullptr, count}});
+    }
+
+    /** Resolves the vertex pointers once all shapes are in place. */
+    void finish()
+    {
+        for (u64 i = 0; i < colliders.size(); ++i) {
+            colliders[i].polygon.xs = xs.data() + first_vertex[i];
+            colliders[i].polygon.ys = ys.data() + first_vertex[i];
+        }
+    }
+};
+
+auto random_hull(vec2 center, f32 size, std::mt19937& random)
+    -> std::vector<vec2>
+{
+    std::uniform_real_distribution<f32> unit{-1.0f, 1.0f};
+    std::uniform_int_distribution<u32> count{3, 16};
+    std::vector<vec2> points(count(random));
+    for (auto& point : points) {
+        point = center + vec2{unit(random), unit(random)} * size;
+    }
+    return engine::collision::convex_hull(points);
+}
+
+auto square(vec2 corner, f32 size) -> std::vector<vec2>
+{
+    return {
+        corner,
+        corner + vec2{size, 0.0f},
+        corner + vec2{size, size},
+        corner + vec2{0.0f, size},
+    };
+}
+
+/**
+ * Adds shapes with known edge cases and appends the pairs among them that
+ * must be tested to `pairs`.
+ */
+void add_special_shapes(Scene& scene, std::vector<CollisionPair>& pairs)
+{
+    auto pair = [&](u32 a, u32 b) { pairs.push_back({a, b}); };
+    auto next = [&] { return static_cast<u32>(scene.colliders.size()); };
+
+    // sharing an edge, meeting at one corner, and one unit apart; the
+    // corner is a diamond's so that the bounding circles are not exactly
+    // tangent, where the early-out may round either way
+    u32 base = next();
+    const vec2 diamond[] = {
+        {132.0f, 116.0f},
+        {140.0f, 108.0f},
+        {148.0f, 116.0f},
+        {140.0f, 124.0f},
+    };
+    scene.add(square({100.0f, 100.0f}, 16.0f));
+    scene.add(square({116.0f, 100.0f}, 16.0f));
+    scene.add(diamond);
+    scene.add(square({100.0f, 117.0f}, 16.0f));
+    pair(base, base + 1);
+    pair(base + 1, base + 2);
+    pair(base, base + 3);
+    pair(base, base + 2);
+
+    // one inside the other, both ways round
+    base = next();
+    scene.add(square({200.0f, 200.0f}, 40.0f));
+    scene.add(square({210.0f, 210.0f}, 8.0f));
+    pair(base, base + 1);
+    pair(base + 1, base);
+
+    // degenerate outlines: empty, a point, a segment, collinear points
+    // (their hull is a segment) and a sliver, all crossing one square
+    base = next();
+    const vec2 point[] = {{300.0f, 100.0f}};
+    const vec2 segment[] = {{290.0f, 90.0f}, {310.0f, 110.0f}};
+    const vec2 collinear[] = {
+        {280.0f, 100.0f},
+        {300.0f, 100.0f},
+        {320.0f, 100.0f},
+    };
+    const vec2 sliver[] = {
+        {280.0f, 101.0f},
+        {320.0f, 101.0f},
+        {300.0f, 101.01f},
+    };
+    scene.add({});
+    scene.add(point);
+    scene.add(segment);
+    scene.add(engine::collision::convex_hull(collinear));
+    scene.add(engine::collision::convex_hull(sliver));
+    scene.add(square({295.0f, 95.0f}, 10.0f));
+    for (u32 a = base; a < base + 6; ++a) {
+        for (u32 b = base; b < base + 6; ++b) {
+            if (a != b) {
+                pair(a, b);
+            }
+        }
+    }
+
+    // overlapping only across the seams, including the corner
+    auto width = static_cast<f32>(WORLD.width);
+    auto height = static_cast<f32>(WORLD.height);
+    base = next();
+    scene.add(square({width - 6.0f, 50.0f}, 10.0f));
+    scene.add(square({-2.0f, 52.0f}, 10.0f));
+    scene.add(square({60.0f, height - 6.0f}, 10.0f));
+    scene.add(square({62.0f, -2.0f}, 10.0f));
+    scene.add(square({width - 5.0f, height - 5.0f}, 10.0f));
+    scene.add(square({-3.0f, -3.0f}, 10.0f));
+    pair(base, base + 1);
+    pair(base + 2, base + 3);
+    pair(base + 4, base + 5);
+}
+
+/** The displacement NarrowPhase applies: the nearest periodic image. */
+auto seam_offset(const Collider& a, const Collider& b) -> vec2
+{
+    auto width = static_cast<f32>(WORLD.width);
+    auto height = static_cast<f32>(WORLD.height);
+    vec2 delta = b.center - a.center;
+    return {
+        -width * std::nearbyint(delta.x / width),
+        -height * std::nearbyint(delta.y / height),
+    };
+}
+
+auto less(const CollisionPair& lhs, const CollisionPair& rhs) -> bool
+{
+    return lhs.a < rhs.a || (lhs.a == rhs.a && lhs.b < rhs.b);
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int
+{
+    u32 runs = DEFAULT_RUNS;
+    if (argc == 2) {
+        std::string_view arg{argv[1]};
+        auto [end, error] =
+            std::from_chars(arg.data(), arg.data() + arg.size(), runs);
+        if (error != std::errc{} || end != arg.data() + arg.size() ||
+            runs == 0) {
+            std::println("usage: collision_bench [runs]");
+            return 1;
+        }
+    } else if (argc > 2) {
+        std::println("usage: collision_bench [runs]");
+        return 1;
+    }
+
+    std::mt19937 random{0xc011};
+    Scene scene{};
+    std::vector<CollisionPair> candidates{};
+    add_special_shapes(scene, candidates);
+
+    // random hulls, some straddling the seams since centers go anywhere
+    auto first_random = static_cast<u32>(scene.colliders.size());
+    std::uniform_real_distribution<f32> x{0.0f, static_cast<f32>(WORLD.width)};
+    std::uniform_real_distribution<f32> y{0.0f, static_cast<f32>(WORLD.height)};
+    std::uniform_real_distribution<f32> size{2.0f, 24.0f};
+    for (u32 i = 0; i < RANDOM_SHAPES; ++i) {
+        scene.add(random_hull({x(random), y(random)}, size(random), random));
+    }
+    scene.finish();
+
+    auto shape_count = static_cast<u32>(scene.colliders.size());
+    std::uniform_int_distribution<u32> shape{first_random, shape_count - 1};
+    while (candidates.size() < CANDIDATES) {
+        u32 a = shape(random);
+        u32 b = shape(random);
+        if (a != b) {
+            candidates.push_back({a, b});
+        }
+    }
+
+    // the reference sees every pair, not only those passing the circles
+    std::vector<CollisionPair> expected{};
+    for (const auto& pair : candidates) {
+        const auto& a = scene.colliders[pair.a];
+        const auto& b = scene.colliders[pair.b];
+        if (engine::collision::polygons_overlap_reference(
+                a.polygon,
+                b.polygon,
+                seam_offset(a, b)
+            )) {
+            expected.push_back(pair);
+        }
+    }
+
+    engine::collision::NarrowPhase narrow_phase{};
+    std::vector<CollisionPair> hits{};
+    narrow_phase.run(scene.colliders, candidates, WORLD, hits);
+
+    std::sort(expected.begin(), expected.end(), less);
+    std::sort(hits.begin(), hits.end(), less);
+    std::vector<CollisionPair> missed{};
+    std::vector<CollisionPair> extra{};
+    std::set_difference(
+        expected.begin(),
+        expected.end(),
+        hits.begin(),
+        hits.end(),
+        std::back_inserter(missed),
+        less
+    );
+    std::set_difference(
+        hits.begin(),
+        hits.end(),
+        expected.begin(),
+        expected.end(),
+        std::back_inserter(extra),
+        less
+    );
+    for (const auto& pair : missed) {
+        std::println("MISSED {} {}", pair.a, pair.b);
+    }
+    for (const auto& pair : extra) {
+        std::println("EXTRA {} {}", pair.a, pair.b);
+    }
+    if (!missed.empty() || !extra.empty()) {
+        std::println(
+            "{} missed and {} extra hits out of {} expected",
+            missed.size(),
+            extra.size(),
+            expected.size()
+        );
+        return 1;
+    }
+    std::println(
+        "{} candidates, {} hits: all match the reference",
+        candidates.size(),
+        expected.size()
+    );
+
+    auto start = engine::time::Instant::now();
+    for (u32 i = 0; i < runs; ++i) {
+        hits.clear();
+        narrow_phase.run(scene.colliders, candidates, WORLD, hits);
+    }
+    auto elapsed = engine::time::Duration::from(start).nanosecond_value();
+
+    auto pairs = static_cast<f64>(candidates.size()) * runs;
+    std::println(
+        "{} runs: {:.1f} M pairs/s, {} of {} pairs passed the circle test",
+        runs,
+        pairs / 1e6 / (static_cast<f64>(elapsed) / 1e9),
+        narrow_phase.circle_survivors(),
+        candidates.size()
+    );
+    return 0;
+}
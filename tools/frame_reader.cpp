@@ -0,0 +1,100 @@
+//
+// Reference reader of a frame export (see FrameExport): maps the segment
+// the game publishes with --export-frames <name>, copies every new frame
+// out and reports the throughput once per second. Optionally the frames are
+// appended to a raw BGRA file.
+//
+// usage: frame_reader [name] [seconds] [raw output file]
+//
+
+#include "../src/core.h"
+#include "../src/frame_export.h"
+#include "../src/time.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <print>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using engine::time::Duration;
+using engine::time::Instant;
+using engine::time::TimeUnit;
+
+auto main(int argc, char** argv) -> int
+{
+    std::string_view name = argc > 1 ? argv[1] : "asteroids-frames";
+    u64 seconds = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10;
+
+    std::ofstream output{};
+    if (argc > 3) {
+        output.open(argv[3], std::ios::binary | std::ios::trunc);
+    }
+
+    engine::capture::FrameReader reader{};
+    if (!reader.open(name)) {
+        std::println("no frame export named '{}'", name);
+        return 1;
+    }
+
+    const auto& header = reader.header();
+    std::println(
+        "{}: {}x{}, {} slots",
+        name,
+        header.width,
+        header.height,
+        header.slot_count
+    );
+
+    std::vector<engine::graphics::ARGB> pixels(
+        static_cast<u64>(header.width) * static_cast<u64>(header.height)
+    );
+    u64 frame_bytes = pixels.size() * sizeof(engine::graphics::ARGB);
+
+    u64 last_frame = 0;
+    u64 frames = 0;
+    u64 skipped = 0;
+    u64 torn = 0;
+    auto start = Instant::now();
+    auto report = start;
+    auto run_time = Duration::of(seconds, TimeUnit::SECONDS);
+    auto report_interval = Duration::of(1, TimeUnit::SECONDS);
+
+    while (Duration::from(start) < run_time) {
+        engine::capture::FrameView view{};
+        if (reader.read(last_frame, pixels, view)) {
+            if (last_frame != 0) {
+                skipped += view.frame_number - last_frame - 1;
+            }
+            last_frame = view.frame_number;
+            ++frames;
+            if (output.is_open()) {
+                output.write(
+                    reinterpret_cast<const char*>(pixels.data()),
+                    static_cast<std::streamsize>(frame_bytes)
+                );
+            }
+        } else if (reader.acquire(last_frame, view)) {
+            // a newer frame exists but was overwritten during the copy
+            ++torn;
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        if (Duration::between(report, Instant::now()) >= report_interval) {
+            auto elapsed = Duration::from(start).value(TimeUnit::MILLISECONDS);
+            f64 elapsed_s = static_cast<f64>(std::max<u64>(elapsed, 1)) / 1e3;
+            std::println(
+                "{} frames ({:.1f}/s, {:.1f} MB/s), {} skipped, {} torn",
+                frames,
+                static_cast<f64>(frames) / elapsed_s,
+                static_cast<f64>(frames * frame_bytes) / elapsed_s / 1e6,
+                skipped,
+                torn
+            );
+            report = Instant::now();
+        }
+    }
+    return 0;
+}
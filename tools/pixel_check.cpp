@@ -0,0 +1,276 @@
+//
+// Validates the vectorized pixel format conversions against the per-pixel
+// reference and measures their throughput.
+//
+// Every format is converted at odd and SIMD-unfriendly widths, with padded
+// source and target strides, and in place. The output must match the
+// reference byte for byte, padding included. Then each kernel converts a
+// full HD frame repeatedly and the source bytes per second are reported.
+//
+// usage: pixel_check [frames]
+//
+
+#include "../src/core.h"
+#include "../src/graphics.h"
+#include "../src/pixel_format.h"
+#include "../src/time.h"
+#include <charconv>
+#include <cstring>
+#include <print>
+#include <random>
+#include <string_view>
+#include <vector>
+
+using engine::graphics::ARGB;
+using engine::graphics::PixelFormat;
+
+namespace {
+
+constexpr u32 DEFAULT_FRAMES = 200;
+constexpr u8 PADDING_BYTE = 0xcd;
+
+struct FormatName {
+    PixelFormat format;
+    const char* name;
+};
+
+constexpr FormatName FORMATS[] = {
+    {PixelFormat::BGRA32, "BGRA32"},
+    {PixelFormat::RGBA32, "RGBA32"},
+    {PixelFormat::BGR24, "BGR24"},
+    {PixelFormat::RGB24, "RGB24"},
+    {PixelFormat::RGB565, "RGB565"},
+    {PixelFormat::GRAY8, "GRAY8"},
+};
+
+/** Source pixels with random colors and alpha, rows `stride` bytes apart. */
+auto random_image(s32 width, s32 height, s64 stride, std::mt19937& random)
+    -> std::vector<u8>
+{
+    std::vector<u8> bytes(static_cast<u64>(stride * height), PADDING_BYTE);
+    for (s32 y = 0; y < height; ++y) {
+        for (s32 x = 0; x < width; ++x) {
+            auto value = static_cast<u32>(random());
+            auto offset = static_cast<u64>(y * stride + x * 4);
+            std::memcpy(&bytes[offset], &value, sizeof(value));
+        }
+    }
+    return bytes;
+}
+
+/**
+ * Converts one image with both implementations into pre-filled targets and
+ * compares the whole buffers, so that writes past a row show up too.
+ */
+auto check_strided(
+    PixelFormat format,
+    s32 width,
+    s32 height,
+    s64 source_padding,
+    s64 target_padding,
+    std::mt19937& random
+) -> bool
+{
+    s64 source_stride = width * 4 + source_padding;
+    s64 target_stride =
+        width * static_cast<s64>(bytes_per_pixel(format)) + target_padding;
+    auto source = random_image(width, height, source_stride, random);
+    const auto* pixels = reinterpret_cast<const ARGB*>(source.data());
+
+    auto size = static_cast<u64>(target_stride * height);
+    std::vector<u8> expected(size, PADDING_BYTE);
+    std::vector<u8> actual(size, PADDING_BYTE);
+    engine::graphics::convert_pixels_reference(
+        pixels,
+        source_stride,
+        expected.data(),
+        target_stride,
+        format,
+        width,
+        height
+    );
+    engine::graphics::convert_pixels(
+        pixels,
+        source_stride,
+        actual.data(),
+        target_stride,
+        format,
+        width,
+        height
+    );
+    return expected == actual;
+}
+
+/** Converts within the source buffer and compares the converted rows. */
+auto check_in_place(
+    PixelFormat format,
+    s32 width,
+    s32 height,
+    s64 source_padding,
+    std::mt19937& random
+) -> bool
+{
+    s64 source_stride = width * 4 + source_padding;
+    // tightly packed rows overlap the source of later rows, which is the
+    // hard case for in-place conversion
+    s64 target_stride = width * static_cast<s64>(bytes_per_pixel(format));
+    auto source = random_image(width, height, source_stride, random);
+
+    std::vector<u8> expected(static_cast<u64>(target_stride * height));
+    engine::graphics::convert_pixels_reference(
+        reinterpret_cast<const ARGB*>(source.data()),
+        source_stride,
+        expected.data(),
+        target_stride,
+        format,
+        width,
+        height
+    );
+    engine::graphics::convert_pixels(
+        reinterpret_cast<const ARGB*>(source.data()),
+        source_stride,
+        source.data(),
+        target_stride,
+        format,
+        width,
+        height
+    );
+    return std::memcmp(source.data(), expected.data(), expected.size()) == 0;
+}
+
+auto validate() -> u32
+{
+    constexpr s32 WIDTHS[] = {1, 2, 3, 5, 7, 8, 15, 16, 17, 31, 33, 65, 641};
+    constexpr s32 HEIGHTS[] = {1, 3, 8};
+    constexpr s64 SOURCE_PADDINGS[] = {0, 4, 60};
+    constexpr s64 TARGET_PADDINGS[] = {0, 1, 3, 17};
+
+    std::mt19937 random{0x9e3779b9};
+    u32 failures = 0;
+    for (const auto& [format, name] : FORMATS) {
+        for (s32 width : WIDTHS) {
+            for (s32 height : HEIGHTS) {
+                for (s64 source_padding : SOURCE_PADDINGS) {
+                    for (s64 target_padding : TARGET_PADDINGS) {
+                        if (!check_strided(
+                                format,
+                                width,
+                                height,
+                                source_padding,
+                                target_padding,
+                                random
+                            )) {
+                            std::println(
+                                "MISMATCH {} {}x{} source padding {} "
+                                "target padding {}",
+                                name,
+                                width,
+                                height,
+                                source_padding,
+                                target_padding
+                            );
+                            ++failures;
+                        }
+                    }
+                    if (!check_in_place(
+                            format,
+                            width,
+                            height,
+                            source_padding,
+                            random
+                        )) {
+                        std::println(
+                            "MISMATCH {} {}x{} in place, source padding {}",
+                            name,
+                            width,
+                            height,
+                            source_padding
+                        );
+                        ++failures;
+                    }
+                }
+            }
+        }
+    }
+    return failures;
+}
+
+using ConvertFunction = void (*)(
+    const ARGB*,
+    s64,
+    void*,
+    s64,
+    PixelFormat,
+    s32,
+    s32
+);
+
+/** Source megabytes per second converting a full HD frame. */
+auto throughput(ConvertFunction convert, PixelFormat format, u32 frames)
+    -> f64
+{
+    constexpr s32 WIDTH = 1920;
+    constexpr s32 HEIGHT = 1080;
+    std::mt19937 random{1};
+    auto source = random_image(WIDTH, HEIGHT, WIDTH * 4, random);
+    std::vector<u8> target(static_cast<u64>(WIDTH) * HEIGHT * 4);
+
+    auto start = engine::time::Instant::now();
+    for (u32 i = 0; i < frames; ++i) {
+        convert(
+            reinterpret_cast<const ARGB*>(source.data()),
+            WIDTH * 4,
+            target.data(),
+            WIDTH * static_cast<s64>(bytes_per_pixel(format)),
+            format,
+            WIDTH,
+            HEIGHT
+        );
+    }
+    auto elapsed = engine::time::Duration::from(start).nanosecond_value();
+
+    auto bytes = static_cast<f64>(source.size()) * frames;
+    return bytes / 1e6 / (static_cast<f64>(elapsed) / 1e9);
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int
+{
+    u32 frames = DEFAULT_FRAMES;
+    if (argc == 2) {
+        std::string_view arg{argv[1]};
+        auto [end, error] =
+            std::from_chars(arg.data(), arg.data() + arg.size(), frames);
+        if (error != std::errc{} || end != arg.data() + arg.size() ||
+            frames == 0) {
+            std::println("usage: pixel_check [frames]");
+            return 1;
+        }
+    } else if (argc > 2) {
+        std::println("usage: pixel_check [frames]");
+        return 1;
+    }
+
+    u32 failures = validate();
+    if (failures > 0) {
+        std::println("{} conversions differ from the reference", failures);
+        return 1;
+    }
+    std::println("all conversions match the reference");
+
+    std::println("{:<8} {:>12} {:>12}", "format", "SIMD MB/s", "ref MB/s");
+    for (const auto& [format, name] : FORMATS) {
+        std::println(
+            "{:<8} {:>12.0f} {:>12.0f}",
+            name,
+            throughput(engine::graphics::convert_pixels, format, frames),
+            throughput(
+                engine::graphics::convert_pixels_reference,
+                format,
+                frames
+            )
+        );
+    }
+    return 0;
+}
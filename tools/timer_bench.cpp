@@ -0,0 +1,286 @@
+//
+// Runs the same timer workload on TimerWheel and on a binary heap built on
+// std::priority_queue, and prints the time each takes.
+//
+// Thousands of timers are pending at once. Every timer reschedules itself
+// when it fires, mostly within ten seconds and sometimes minutes ahead,
+// and a number of timers are cancelled and rescheduled every tick. All
+// delays and cancels are derived from a hash of (timer, count) rather than
+// a shared generator, so both implementations see exactly the same
+// workload no matter in which order a tick's callbacks run; the fire
+// counts are compared to prove it.
+//
+// usage: timer_bench [timers] [ticks]
+//
+
+#include "../src/core.h"
+#include "../src/time.h"
+#include "../src/timer_wheel.h"
+#include <charconv>
+#include <functional>
+#include <print>
+#include <queue>
+#include <string_view>
+#include <vector>
+
+using engine::timers::TimerCallback;
+using engine::timers::TimerId;
+using engine::timers::TimerWheel;
+
+namespace {
+
+constexpr u32 DEFAULT_TIMERS = 10000;
+constexpr u32 DEFAULT_TICKS = 100000;
+constexpr u32 CANCELS_PER_TICK = 16;
+constexpr u32 TICKS_PER_SECOND = 30;
+
+/**
+ * Priority queue counterpart of TimerWheel with the same interface and
+ * semantics: stale handles are rejected by generation, cancelled timers
+ * are dropped lazily when they reach the top, and due callbacks run as a
+ * batch after the tick.
+ */
+class HeapTimers final {
+public:
+    auto schedule_ticks(u64 ticks, TimerCallback callback, void* context)
+        -> TimerId
+    {
+        u32 index = 0;
+        if (!free_.empty()) {
+            index = free_.back();
+            free_.pop_back();
+        } else {
+            index = static_cast<u32>(generations_.size());
+            generations_.push_back(0);
+        }
+
+        u64 expires = now_ + (ticks > 0 ? ticks : 1);
+        u32 generation = generations_[index];
+        queue_.push(
+            {expires, sequence_++, callback, context, index, generation}
+        );
+        ++pending_;
+        return {index, generation};
+    }
+
+    auto cancel(TimerId id) -> bool
+    {
+        if (id.index >= generations_.size() ||
+            generations_[id.index] != id.generation) {
+            return false;
+        }
+        release(id.index);
+        return true;
+    }
+
+    void advance()
+    {
+        ++now_;
+        while (!queue_.empty() && queue_.top().expires <= now_) {
+            Entry entry = queue_.top();
+            queue_.pop();
+            if (generations_[entry.index] == entry.generation) {
+                expired_.push_back(entry);
+                release(entry.index);
+            }
+        }
+        for (const auto& entry : expired_) {
+            entry.callback(entry.context);
+        }
+        expired_.clear();
+    }
+
+    [[nodiscard]] auto pending() const -> u32 { return pending_; }
+
+private:
+    struct Entry {
+        u64 expires;
+        // keeps timers due in the same tick in scheduling order
+        u64 sequence;
+        TimerCallback callback;
+        void* context;
+        u32 index;
+        u32 generation;
+
+        auto operator>(const Entry& other) const -> bool
+        {
+            return expires != other.expires ? expires > other.expires
+                                            : sequence > other.sequence;
+        }
+    };
+
+    u64 now_{0};
+    u64 sequence_{0};
+    u32 pending_{0};
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<>> queue_{};
+    std::vector<u32> generations_{};
+    std::vector<u32> free_{};
+    std::vector<Entry> expired_{};
+
+    void release(u32 index)
+    {
+        ++generations_[index];
+        free_.push_back(index);
+        --pending_;
+    }
+};
+
+/** SplitMix64 finalizer. */
+auto mix(u64 value) -> u64
+{
+    value += 0x9e3779b97f4a7c15;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+    return value ^ (value >> 31);
+}
+
+/**
+ * Delay in ticks for the `count`th scheduling of timer `timer`, at the
+ * game's TICKS_PER_SECOND.
+ */
+auto delay(u32 timer, u64 count) -> u64
+{
+    u64 hash = mix((u64{timer} << 40) ^ count);
+    // one in sixteen lands beyond the first two wheel levels
+    if ((hash & 15) == 0) {
+        return 4096 + (hash >> 8) % 20000;
+    }
+    return 1 + (hash >> 8) % 300;
+}
+
+template <typename Timers>
+class Workload final {
+public:
+    Workload(Timers& timers, u32 count) :
+        timers_(timers),
+        clients_(count)
+    {
+        for (u32 i = 0; i < count; ++i) {
+            clients_[i] = {this, i, 0, {}};
+            schedule(clients_[i]);
+        }
+    }
+
+    void run(u64 ticks)
+    {
+        auto count = static_cast<u32>(clients_.size());
+        for (u64 tick = 0; tick < ticks; ++tick) {
+            for (u32 i = 0; i < CANCELS_PER_TICK; ++i) {
+                auto& client = clients_[mix(tick * CANCELS_PER_TICK + i) %
+                                        count];
+                if (timers_.cancel(client.id)) {
+                    ++cancels_;
+                    schedule(client);
+                }
+            }
+            timers_.advance();
+        }
+    }
+
+    [[nodiscard]] auto fires() const -> u64 { return fires_; }
+    [[nodiscard]] auto cancels() const -> u64 { return cancels_; }
+
+private:
+    struct Client {
+        Workload* workload;
+        u32 index;
+        u64 scheduled;
+        TimerId id;
+    };
+
+    Timers& timers_;
+    std::vector<Client> clients_;
+    u64 fires_{0};
+    u64 cancels_{0};
+
+    void schedule(Client& client)
+    {
+        client.id = timers_.schedule_ticks(
+            delay(client.index, client.scheduled++),
+            fire,
+            &client
+        );
+    }
+
+    static void fire(void* context)
+    {
+        auto& client = *static_cast<Client*>(context);
+        ++client.workload->fires_;
+        client.workload->schedule(client);
+    }
+};
+
+struct Result {
+    u64 nanoseconds;
+    u64 fires;
+    u64 cancels;
+};
+
+template <typename Timers>
+auto measure(Timers& timers, u32 count, u32 ticks) -> Result
+{
+    auto start = engine::time::Instant::now();
+    Workload<Timers> workload{timers, count};
+    workload.run(ticks);
+    auto elapsed = engine::time::Duration::from(start).nanosecond_value();
+    return {elapsed, workload.fires(), workload.cancels()};
+}
+
+auto parse(std::string_view arg, u32& value) -> bool
+{
+    auto [end, error] =
+        std::from_chars(arg.data(), arg.data() + arg.size(), value);
+    return error == std::errc{} && end == arg.data() + arg.size() &&
+           value > 0;
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int
+{
+    u32 count = DEFAULT_TIMERS;
+    u32 ticks = DEFAULT_TICKS;
+    if (argc > 3 || (argc > 1 && !parse(argv[1], count)) ||
+        (argc > 2 && !parse(argv[2], ticks))) {
+        std::println("usage: timer_bench [timers] [ticks]");
+        return 1;
+    }
+
+    TimerWheel wheel{
+        engine::time::Duration::of(1000000000 / TICKS_PER_SECOND)
+    };
+    auto wheel_result = measure(wheel, count, ticks);
+    HeapTimers heap{};
+    auto heap_result = measure(heap, count, ticks);
+
+    if (wheel_result.fires != heap_result.fires ||
+        wheel_result.cancels != heap_result.cancels) {
+        std::println(
+            "workloads differ: wheel {} fires {} cancels, "
+            "heap {} fires {} cancels",
+            wheel_result.fires,
+            wheel_result.cancels,
+            heap_result.fires,
+            heap_result.cancels
+        );
+        return 1;
+    }
+
+    std::println(
+        "{} timers, {} ticks: {} fires, {} cancels",
+        count,
+        ticks,
+        wheel_result.fires,
+        wheel_result.cancels
+    );
+    auto milliseconds = [](const Result& result) {
+        return static_cast<f64>(result.nanoseconds) / 1e6;
+    };
+    std::println("wheel: {:.1f} ms", milliseconds(wheel_result));
+    std::println("heap:  {:.1f} ms", milliseconds(heap_result));
+    std::println(
+        "wheel/heap: {:.1f}%",
+        100.0 * milliseconds(wheel_result) / milliseconds(heap_result)
+    );
+    return 0;
+}